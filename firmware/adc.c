@@ -0,0 +1,78 @@
+#include "config.h"
+#include "adc.h"
+
+#include <util/delay.h>
+
+static uint8_t win;          /* chamadas restantes da janela; 0 = fechada */
+static uint8_t want_temp;
+static uint8_t temp_ready;
+static uint16_t temp_raw;
+
+void adc_init(void)
+{
+    ADCSRA = _BV(ADEN) | ADC_PRESCALER_BITS;
+}
+
+uint16_t adc_read(uint8_t admux)
+{
+    uint8_t i;
+
+    if (ADMUX != admux) {
+        ADMUX = admux;
+        i = 2;
+    } else {
+        i = 1;
+    }
+    while (i--) {   /* wcet-loop: 2 */
+        ADCSRA |= _BV(ADSC);
+        /* 13 ciclos de ADC x 128 = 1664 ciclos, no mínimo 3 por volta */
+        loop_until_bit_is_clear(ADCSRA, ADSC);   /* wcet-loop: 560 */
+    }
+    return ADC;
+}
+
+uint16_t adc_read_1v1_settled(uint8_t channel)
+{
+    if (ADMUX != (ADC_REF_1V1 | channel)) {
+        ADMUX = ADC_REF_1V1 | channel;
+        _delay_ms(ADC_1V1_SETTLE_MS);
+    }
+    return adc_read(ADC_REF_1V1 | channel);
+}
+
+void adc_temp_request(void)
+{
+    want_temp = 1;
+}
+
+uint8_t adc_temp_take(uint16_t *raw)
+{
+    if (!temp_ready)
+        return 0;
+    temp_ready = 0;
+    *raw = temp_raw;
+    return 1;
+}
+
+uint8_t adc_window(uint8_t idle, uint8_t ticks)
+{
+    if (win == 0) {
+        if (!want_temp || !idle)
+            return 0;
+        /* só troca a referência; o AREF desce enquanto as chamadas passam */
+        ADMUX = ADC_REF_1V1 | ADC_CH_TEMP_INTERNAL;
+        win = ticks;
+        return 1;
+    }
+    if (--win == 0) {
+        temp_raw = adc_read(ADC_REF_1V1 | ADC_CH_TEMP_INTERNAL);
+        want_temp = 0;
+        temp_ready = 1;
+    }
+    return 1;
+}
+
+uint8_t adc_in_window(void)
+{
+    return win != 0;
+}
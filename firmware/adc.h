@@ -0,0 +1,52 @@
+/*
+ * ADC compartilhado (LDR, sensor de temperatura, NTC).
+ *
+ * Leituras simples e bloqueantes (~104 µs a 125 kHz), sempre fora de
+ * interrupção. Quem chama passa o ADMUX completo (referência + canal).
+ *
+ * O sensor interno exige a referência de 1,1 V. Com o capacitor usual no
+ * AREF, descer de AVcc para 1,1 V leva dezenas de ms, e uma conversão
+ * descartada não basta. A temperatura é lida numa janela própria: quem a
+ * usa pede com adc_temp_request(), e o dono das leituras periódicas em AVcc
+ * (hit.c, a cada amostra do LDR) abre a janela com adc_window() quando
+ * pode ficar sem amostras por ADC_1V1_SETTLE_MS.
+ */
+#ifndef ADC_H
+#define ADC_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#define ADC_REF_AVCC  _BV(REFS0)
+#define ADC_REF_1V1   (_BV(REFS1) | _BV(REFS0))
+
+/* AREF de AVcc a 1,1 V até 1 LSB: ~8 · 32 kΩ internos · 100 nF. */
+#ifndef ADC_1V1_SETTLE_MS
+#define ADC_1V1_SETTLE_MS 30
+#endif
+
+void adc_init(void);
+
+/* A primeira conversão após trocar ADMUX é descartada. */
+uint16_t adc_read(uint8_t admux);
+
+/* Referência de 1,1 V já assentada (boot, antes das leituras periódicas). */
+uint16_t adc_read_1v1_settled(uint8_t channel);
+
+/* Pede uma leitura do sensor interno na próxima janela. */
+void adc_temp_request(void);
+
+/* Retorna 1 e a leitura se a janela pedida terminou. */
+uint8_t adc_temp_take(uint16_t *raw);
+
+/*
+ * Chamar antes de cada leitura periódica em AVcc; 'idle' diz se dá para
+ * abrir a janela agora e 'ticks' é quantas chamadas ela dura. Retorna 1
+ * enquanto a janela está aberta: não ler em AVcc nesta chamada.
+ */
+uint8_t adc_window(uint8_t idle, uint8_t ticks);
+
+/* Janela aberta: ADMUX está na referência de 1,1 V. */
+uint8_t adc_in_window(void);
+
+#endif /* ADC_H */
@@ -0,0 +1,100 @@
+#include "config.h"
+#include "buzzer.h"
+#include "progmem.h"
+
+#include <avr/io.h>
+
+/* Prescaler 64: f = F_CPU / (2 · 64 · (1 + OCR2A)), de 488 Hz a 62 kHz. */
+#define BUZZER_CS    (_BV(CS22))
+#define NOTE(hz)     ((uint8_t)(F_CPU / 128 / (hz) - 1))
+#define REST         0
+#define END          0
+
+/* Pares (OCR2A, duração em ticks de 10 ms); duração 0 encerra. */
+static const uint8_t melody_hit[] PROGMEM = {
+    NOTE(2093), 6, END, END
+};
+static const uint8_t melody_last_life[] PROGMEM = {
+    NOTE(1568), 8, REST, 4, NOTE(1568), 8, REST, 4, NOTE(1568), 8, END, END
+};
+static const uint8_t melody_out[] PROGMEM = {
+    NOTE(1047), 15, NOTE(880), 15, NOTE(698), 15, NOTE(523), 40, END, END
+};
+
+static const uint8_t *const melodies[MELODY_COUNT] PROGMEM = {
+    [MELODY_HIT]       = melody_hit,
+    [MELODY_LAST_LIFE] = melody_last_life,
+    [MELODY_OUT]       = melody_out,
+};
+
+static const uint8_t *cursor;   /* 0 = parado */
+static uint8_t remaining;
+
+static void tone(uint8_t ocr)
+{
+    if (ocr == REST) {
+        TCCR2A = _BV(WGM21);            /* desconecta OC2B */
+        BUZZER_PORT &= ~_BV(BUZZER_PIN);
+        return;
+    }
+    OCR2A = ocr;
+    if (TCNT2 > ocr)
+        TCNT2 = 0;                      /* senão contaria até 255 */
+    TCCR2A = _BV(COM2B0) | _BV(WGM21);
+}
+
+/* Carrega a próxima nota; retorna 0 no fim da melodia. */
+static uint8_t next_note(void)
+{
+    uint8_t ocr = pgm_u8(cursor);
+    uint8_t ticks = pgm_u8(cursor + 1);
+
+    if (ticks == END)
+        return 0;
+    cursor += 2;
+    remaining = ticks;
+    tone(ocr);
+    return 1;
+}
+
+void buzzer_init(void)
+{
+    BUZZER_PORT &= ~_BV(BUZZER_PIN);
+    BUZZER_DDR |= _BV(BUZZER_PIN);
+    TCCR2A = _BV(WGM21);
+    TCCR2B = 0;
+    OCR2B = 0;
+    TIMSK2 = 0;
+    cursor = 0;
+}
+
+void buzzer_play(enum buzzer_melody m)
+{
+    if (m >= MELODY_COUNT)
+        return;
+    cursor = (const uint8_t *)pgm_read_ptr(&melodies[m]);
+    TCNT2 = 0;
+    TCCR2B = BUZZER_CS;
+    if (!next_note())
+        buzzer_stop();
+}
+
+void buzzer_stop(void)
+{
+    tone(REST);
+    TCCR2B = 0;
+    cursor = 0;
+}
+
+void buzzer_tick(void)
+{
+    if (!cursor)
+        return;
+    if (--remaining == 0 && !next_note())
+        buzzer_stop();
+}
+
+uint8_t buzzer_busy(void)
+{
+    return cursor != 0;
+}
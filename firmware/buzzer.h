@@ -0,0 +1,33 @@
+/*
+ * Buzzer de feedback de acerto no Timer2.
+ *
+ * O tom é gerado em hardware: Timer2 em CTC com TOP = OCR2A e OC2B
+ * alternando a cada comparação, sem interrupção. A CPU só troca de nota,
+ * em buzzer_tick(), chamado no tick de 10 ms junto das outras tarefas.
+ * Timer0 (motores) e Timer1 (laser) não são tocados.
+ */
+#ifndef BUZZER_H
+#define BUZZER_H
+
+#include <stdint.h>
+
+enum buzzer_melody {
+    MELODY_HIT = 0,
+    MELODY_LAST_LIFE,
+    MELODY_OUT,
+    MELODY_COUNT
+};
+
+void buzzer_init(void);
+
+/* Começa uma melodia, interrompendo a atual. */
+void buzzer_play(enum buzzer_melody m);
+
+void buzzer_stop(void);
+
+/* Chamar a cada 10 ms. */
+void buzzer_tick(void);
+
+uint8_t buzzer_busy(void);
+
+#endif /* BUZZER_H */
@@ -0,0 +1,77 @@
+#include "config.h"
+#include "chanscan.h"
+#include "nrf24.h"
+
+#include <util/delay.h>
+
+void chanscan_run(uint8_t scores[NRF_CHANNELS], uint8_t passes)
+{
+    uint8_t ch, p;
+    uint8_t prev, cur;
+    uint16_t s;
+    uint8_t old_ch = nrf24_read_reg(NRF_REG_RF_CH);
+    uint8_t old_ce = NRF_PORT & _BV(NRF_CE_PIN);
+
+    /* conta direto em scores[] e suaviza no mesmo buffer */
+    for (ch = 0; ch < NRF_CHANNELS; ch++)   /* wcet-loop: NRF_CHANNELS */
+        scores[ch] = 0;
+
+    nrf24_listen(0);
+    for (p = 0; p < passes; p++) {   /* wcet-loop: 255 */
+        for (ch = 0; ch < NRF_CHANNELS; ch++) { /* wcet-loop: 126 */
+            nrf24_set_channel(ch);
+            nrf24_listen(1);
+            _delay_us(CHANSCAN_DWELL_US);
+            nrf24_listen(0);
+            if (nrf24_read_reg(NRF_REG_RPD) & 0x01)
+                scores[ch]++;
+        }
+    }
+    nrf24_flush_rx();
+    nrf24_set_channel(old_ch);
+    nrf24_listen(old_ce != 0);
+
+    prev = 0;
+    for (ch = 0; ch < NRF_CHANNELS; ch++) {   /* wcet-loop: NRF_CHANNELS */
+        cur = scores[ch];
+        s = (uint16_t)cur * 2 + prev;
+        if (ch + 1 < NRF_CHANNELS)
+            s += scores[ch + 1];
+        scores[ch] = s > 255 ? 255 : (uint8_t)s;
+        prev = cur;
+    }
+}
+
+static uint8_t too_close(const uint8_t *out, uint8_t n, uint8_t ch,
+                         uint8_t spacing)
+{
+    uint8_t i;
+
+    for (i = 0; i < n; i++)   /* wcet-loop: 255 */
+        if ((ch > out[i] ? ch - out[i] : out[i] - ch) < spacing)
+            return 1;
+    return 0;
+}
+
+uint8_t chanscan_best(const uint8_t scores[NRF_CHANNELS], uint8_t *out,
+                      uint8_t k, uint8_t spacing)
+{
+    uint8_t n = 0;
+    uint16_t level;
+    uint8_t ch;
+
+    /* k é pequeno: varre por nota crescente em vez de ordenar */
+    for (level = 0; level <= 255 && n < k; level++)   /* wcet-loop: 256 */
+        for (ch = 0; ch < NRF_CHANNELS && n < k; ch++) /* wcet-loop: 126 */
+            if (scores[ch] == level && !too_close(out, n, ch, spacing))
+                out[n++] = ch;
+    return n;
+}
+
+uint8_t chanscan_report(uint8_t out[CHANSCAN_REPORT_SIZE],
+                        const uint8_t scores[NRF_CHANNELS])
+{
+    out[0] = EVT_CHANNELS;
+    out[1] = chanscan_best(scores, out + 2, CHANSCAN_REPORT, CHANSCAN_SPACING);
+    return (uint8_t)(2 + out[1]);
+}
@@ -0,0 +1,59 @@
+/*
+ * Varredura de canais livres com o registrador RPD do NRF24L01.
+ *
+ * RPD indica sinal acima de -64 dBm no canal. Cada passada visita todos os
+ * canais uma vez; a nota de um canal é quantas vezes ele estava ocupado,
+ * somada à metade da nota dos vizinhos (o Wi-Fi ocupa vários canais). O
+ * tempo é limitado: passadas · canais · CHANSCAN_DWELL_US.
+ *
+ * O carrinho varre no boot, antes de entrar no link, e manda os canais
+ * mais limpos ao transmissor no payload do ACK (também quando ele pede com
+ * CMD_CHANNELS, command.h):
+ *
+ *   [EVT_CHANNELS] [n] [canal]...   n canais, o mais limpo primeiro
+ */
+#ifndef CHANSCAN_H
+#define CHANSCAN_H
+
+#include <stdint.h>
+
+#define NRF_CHANNELS 126
+
+/* RPD precisa de 170 µs em RX para ser válido. */
+#ifndef CHANSCAN_DWELL_US
+#define CHANSCAN_DWELL_US 200
+#endif
+
+/* 8 passadas ~ 200 ms. */
+#ifndef CHANSCAN_PASSES
+#define CHANSCAN_PASSES 8
+#endif
+
+#define EVT_CHANNELS 0x31
+/* Canais informados e distância mínima entre eles. */
+#ifndef CHANSCAN_REPORT
+#define CHANSCAN_REPORT 4
+#endif
+#ifndef CHANSCAN_SPACING
+#define CHANSCAN_SPACING 3
+#endif
+#define CHANSCAN_REPORT_SIZE (2 + CHANSCAN_REPORT)
+
+/*
+ * Preenche scores[] (menor = mais limpo). O buffer é do chamador para não
+ * ocupar SRAM fixa. O canal e o CE do rádio voltam como estavam.
+ */
+void chanscan_run(uint8_t scores[NRF_CHANNELS], uint8_t passes);
+
+/*
+ * Os k canais mais limpos em out[], em ordem crescente de nota, separados
+ * por pelo menos 'spacing' canais entre si. Retorna quantos achou.
+ */
+uint8_t chanscan_best(const uint8_t scores[NRF_CHANNELS], uint8_t *out,
+                      uint8_t k, uint8_t spacing);
+
+/* Monta o EVT_CHANNELS a partir das notas; retorna o tamanho. */
+uint8_t chanscan_report(uint8_t out[CHANSCAN_REPORT_SIZE],
+                        const uint8_t scores[NRF_CHANNELS]);
+
+#endif /* CHANSCAN_H */
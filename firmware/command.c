@@ -0,0 +1,98 @@
+#include "config.h"
+#include "command.h"
+#include "state.h"
+
+static uint8_t slot_offset;
+
+void command_join_group(const uint8_t group_addr[NRF_ADDR_LEN], uint8_t slot)
+{
+    if (slot >= CMD_MAX_CARS)
+        return;
+    nrf24_listen(0);
+    nrf24_set_rx_addr(CMD_PIPE_GROUP, group_addr);
+    nrf24_enable_pipes(nrf24_read_reg(NRF_REG_EN_RXADDR) | _BV(CMD_PIPE_GROUP));
+    nrf24_listen(1);
+    CAR_SET_GROUP_SLOT(slot);
+    slot_offset = CMD_MULTI_HDR + slot * CMD_SLOT_SIZE;
+}
+
+void command_leave_group(void)
+{
+    nrf24_enable_pipes(nrf24_read_reg(NRF_REG_EN_RXADDR) & ~_BV(CMD_PIPE_GROUP));
+    CAR_SET_GROUP_SLOT(CAR_NO_SLOT);
+}
+
+uint8_t command_decode(const uint8_t *pkt, uint8_t len, uint8_t pipe,
+                       struct command *cmd)
+{
+    const uint8_t *s;
+
+    if (pipe == CMD_PIPE_PRIVATE && pkt[0] == CMD_GROUP &&
+        len >= 2 + NRF_ADDR_LEN) {
+        if (pkt[1] < CMD_MAX_CARS)
+            command_join_group(pkt + 2, pkt[1]);
+        else
+            command_leave_group();
+        return 0;
+    }
+    if (pipe == CMD_PIPE_PRIVATE && pkt[0] == CMD_SINGLE &&
+        len >= CMD_SINGLE_SIZE) {
+        s = pkt + 1;
+        cmd->tlm_ack = pkt[4];
+    } else if (pipe == CMD_PIPE_GROUP && pkt[0] == CMD_MULTI &&
+               CAR_GROUP_SLOT() != CAR_NO_SLOT &&
+               len >= slot_offset + CMD_SLOT_SIZE &&
+               (pkt[2] & _BV(CAR_GROUP_SLOT()))) {
+        s = pkt + slot_offset;
+        cmd->tlm_ack = 0;
+    } else {
+        return 0;
+    }
+    cmd->throttle = s[0];
+    cmd->steer = (int8_t)s[1];
+    cmd->flags = s[2];
+    return 1;
+}
+
+uint8_t command_poll_ack(const uint8_t *pkt, uint8_t len, uint8_t pipe)
+{
+    if (pipe != CMD_PIPE_PRIVATE || pkt[0] != CMD_POLL || len < CMD_POLL_SIZE)
+        return 0;
+    return pkt[1];
+}
+
+uint8_t command_control(const uint8_t *pkt, uint8_t len, uint8_t pipe)
+{
+    if (pipe != CMD_PIPE_PRIVATE || len < 1)
+        return 0;
+    switch (pkt[0]) {
+    case CMD_CHANNELS:
+    case CMD_REPAIR:
+    case CMD_MATCH:
+        return pkt[0];
+    case CMD_PWM_FREQ:
+        return len >= CMD_PWM_FREQ_SIZE ? pkt[0] : 0;
+    }
+    return 0;
+}
+
+uint8_t command_build_multi(uint8_t out[CMD_MULTI_SIZE], uint8_t seq,
+                            uint8_t mask, const struct command *cmds)
+{
+    uint8_t i;
+    uint8_t *s = out + CMD_MULTI_HDR;
+
+    out[0] = CMD_MULTI;
+    out[1] = seq;
+    out[2] = mask;
+    for (i = 0; i < CMD_MAX_CARS; i++, s += CMD_SLOT_SIZE) { /* wcet-loop: 6 */
+        if (mask & _BV(i)) {
+            s[0] = cmds[i].throttle;
+            s[1] = (uint8_t)cmds[i].steer;
+            s[2] = cmds[i].flags;
+        } else {
+            s[0] = s[1] = s[2] = 0;
+        }
+    }
+    return CMD_MULTI_SIZE;
+}
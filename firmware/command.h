@@ -0,0 +1,121 @@
+/*
+ * Pacotes de comando de movimento.
+ *
+ * Individual (pipe 0, endereço privado do vínculo, com ACK):
+ *   [CMD_SINGLE] [throttle] [steer] [flags] [tlm_ack]
+ *
+ * tlm_ack é o seq do último registro de telemetria que o transmissor
+ * recebeu (0 = nenhum); é a base das diferenças do próximo (telemetry.h).
+ *
+ * Múltiplo (pipe 1, endereço do grupo), um transmissor guiando até 6
+ * carrinhos:
+ *   [CMD_MULTI] [seq] [mask] slot0 .. slot5, cada slot = throttle steer flags
+ *
+ * O transmissor manda o pacote de grupo com nrf24_write_tx_noack()
+ * (W_TX_PAYLOAD_NOACK): o pipe 1 continua com EN_AA e DPL ligados, como o
+ * datasheet exige para payload dinâmico, mas nenhum carrinho responde, então
+ * os ACKs não colidem.
+ *
+ * Entrada/saída de grupo (pipe 0):
+ *   [CMD_GROUP] [slot] [endereço do grupo, 5 bytes]   slot 0xFF = sair
+ *
+ * Consulta (pipe 0, com ACK), para carrinhos em grupo:
+ *   [CMD_POLL] [tlm_ack]
+ *
+ * Controle (pipe 0, com ACK), tratados por command_control():
+ *   [CMD_CHANNELS]   pede de novo os canais limpos da varredura do boot
+ *                    (EVT_CHANNELS nos próximos ACKs, chanscan.h)
+ *   [CMD_REPAIR]     para os motores e volta ao pareamento (pairing.h)
+ *   [CMD_MATCH]      início de partida: vidas cheias (volta ao jogo quem
+ *                    estava fora), pente cheio e pose zerada
+ *   [CMD_PWM_FREQ] [enum pwm_freq]
+ *                    frequência do PWM deste carrinho, trocada na hora e
+ *                    salva na EEPROM (pwm.h)
+ *
+ * O pacote de grupo não tem ACK, então não traz telemetria nem avisos de
+ * acerto. O transmissor intercala, a cada ciclo de comando, um CMD_POLL no
+ * endereço privado de um dos carrinhos do grupo (rodízio); o ACK dele leva
+ * o que estiver na fila (hitpush.h, telemetry.h). Com 6 carrinhos, cada
+ * um é consultado a cada 6 ciclos de comando.
+ *
+ * Os slots têm posição fixa, então cada carrinho extrai o seu com custo
+ * constante, seja qual for o número de carrinhos. 'mask' diz quais slots
+ * foram preenchidos neste pacote. Os comandos são estado absoluto, então
+ * um pacote repetido não faz mal e não há descarte por seq.
+ */
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <stdint.h>
+
+#include "hit.h"
+#include "nrf24.h"
+
+#define CMD_SINGLE 0x10
+#define CMD_MULTI  0x11
+#define CMD_GROUP  0x12
+#define CMD_POLL   0x13
+#define CMD_CHANNELS 0x14
+#define CMD_REPAIR   0x15
+#define CMD_MATCH    0x16
+#define CMD_PWM_FREQ 0x17
+
+#define CMD_PWM_FREQ_SIZE 2
+
+#define CMD_SINGLE_SIZE 5
+#define CMD_POLL_SIZE   2
+
+#define CMD_SLOT_SIZE   3
+#define CMD_MAX_CARS    6
+#define CMD_MULTI_HDR   3
+#define CMD_MULTI_SIZE  (CMD_MULTI_HDR + CMD_MAX_CARS * CMD_SLOT_SIZE)
+
+#define CMD_PIPE_PRIVATE 0
+#define CMD_PIPE_GROUP   1
+
+/* flags */
+#define CMD_FLAG_FIRE  0x01
+/*
+ * Equipe do carrinho (0..3), definida pelo transmissor. Só vale com
+ * CMD_FLAG_TEAMS; sem ele o jogo é todos contra todos (padrão), sem filtro
+ * de fogo amigo.
+ */
+#define CMD_FLAG_TEAM_SHIFT 1
+#define CMD_FLAG_TEAM_MASK  (3 << CMD_FLAG_TEAM_SHIFT)
+#define CMD_FLAG_TEAMS 0x08
+#define CMD_TEAM(flags) (((flags) & CMD_FLAG_TEAMS) ?                       \
+                         ((flags) & CMD_FLAG_TEAM_MASK) >> CMD_FLAG_TEAM_SHIFT \
+                         : HIT_NO_TEAM)
+
+struct command {
+    uint8_t throttle;
+    int8_t steer;
+    uint8_t flags;
+    uint8_t tlm_ack;   /* só no individual; 0 no de grupo */
+};
+
+/* Entra num grupo: escuta 'group_addr' no pipe 1 e lê o slot dado. */
+void command_join_group(const uint8_t group_addr[NRF_ADDR_LEN], uint8_t slot);
+void command_leave_group(void);
+
+/*
+ * Retorna 1 se o pacote traz um comando para este carrinho. CMD_GROUP é
+ * tratado aqui mesmo (entra ou sai do grupo) e retorna 0.
+ */
+uint8_t command_decode(const uint8_t *pkt, uint8_t len, uint8_t pipe,
+                       struct command *cmd);
+
+/* tlm_ack de um CMD_POLL, ou 0 se o pacote não é uma consulta. */
+uint8_t command_poll_ack(const uint8_t *pkt, uint8_t len, uint8_t pipe);
+
+/* Tipo de um pacote de controle válido no pipe privado, ou 0. */
+uint8_t command_control(const uint8_t *pkt, uint8_t len, uint8_t pipe);
+
+/*
+ * Lado do transmissor: monta o pacote múltiplo. cmds[i] vai para o slot i
+ * se o bit i de 'mask' estiver ligado. Retorna o tamanho.
+ */
+uint8_t command_build_multi(uint8_t out[CMD_MULTI_SIZE], uint8_t seq,
+                            uint8_t mask, const struct command *cmds);
+
+#endif /* COMMAND_H */
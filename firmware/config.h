@@ -0,0 +1,109 @@
+/*
+ * Configuração geral do firmware do carrinho (ATmega328P, C puro).
+ *
+ * Tudo que depende da placa (clock, pinos, canais do ADC) fica aqui para
+ * que os módulos não espalhem números mágicos.
+ */
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <avr/io.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+/* ---- ADC ---------------------------------------------------------------- */
+
+/* Prescaler 128 -> 125 kHz de clock do ADC a 16 MHz. */
+#define ADC_PRESCALER_BITS  (_BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0))
+
+/* Sensor de temperatura interno: MUX = 1000, referência de 1,1 V. */
+#define ADC_CH_TEMP_INTERNAL 8
+
+/*
+ * Termistor NTC opcional no dissipador dos MOSFETs (10k, B=3950, pull-up de
+ * 10k para AVcc). Desligado por padrão: sem ele o modelo térmico sozinho
+ * decide. ADC6/ADC7 só existem no encapsulamento TQFP/QFN; no DIP use um
+ * canal livre de 0 a 5.
+ */
+/* #define ADC_CH_NTC 6 */
+
+/* ---- Motores ------------------------------------------------------------ */
+
+/*
+ * PWM dos motores no Timer0 (o Timer1 é do tick e do laser): OC0A/PD6 motor esquerdo,
+ * OC0B/PD5 motor direito, cada um acionando optoacoplador + IRLZ44N.
+ */
+#define MOTOR_DDR   DDRD
+#define MOTOR_PORT  PORTD
+#define MOTOR_L_PIN PD6
+#define MOTOR_R_PIN PD5
+
+/*
+ * Frequência sem escolha salva na EEPROM (enum pwm_freq; CMD_PWM_FREQ troca
+ * por carrinho). Optoacopladores comuns (PC817) têm atrasos de µs, então
+ * frequências baixas distorcem menos o duty.
+ */
+#define MOTOR_PWM_DEFAULT PWM_FREQ_977
+
+/* ---- Giroscópio (opcional) ----------------------------------------------- */
+
+/*
+ * MPU-6050 no TWI (PC4/SDA, PC5/SCL) para manter o rumo. Com 0 o controle de
+ * rumo vira passagem direta e o TWI não é usado.
+ */
+#define USE_GYRO        1
+#define TWI_FREQ        400000UL
+#define GYRO_I2C_ADDR   0x68
+
+/* ---- Odometria ---------------------------------------------------------- */
+
+/*
+ * Encoders de roda opcionais (PCINT2: PD4 esquerdo, PD7 direito). Com 0 a
+ * odometria estima a velocidade pelo duty do PWM.
+ */
+#define USE_ENCODERS      0
+#define ENC_PORT_PIN      PIND
+#define ENC_L_PIN         PD4
+#define ENC_R_PIN         PD7
+
+/* ---- Rádio NRF24L01 ------------------------------------------------------ */
+
+/* SPI de hardware (PB3/PB4/PB5); CSN em PB2, que também é o SS do mestre. */
+#define NRF_DDR       DDRB
+#define NRF_PORT      PORTB
+#define NRF_CE_PIN    PB1
+#define NRF_CSN_PIN   PB2
+#define NRF_IRQ_PIN   PD2   /* INT0, ativo em 0 */
+
+/* Canal e endereço conhecidos por todos para o pareamento. */
+#define NRF_PAIR_CHANNEL 2
+#define NRF_PAIR_ADDR    { 'P', 'A', 'I', 'R', '0' }
+
+/* ---- Buzzer --------------------------------------------------------------- */
+
+/* Piezo em OC2B/PD3, tom gerado pelo Timer2 sem CPU. */
+#define BUZZER_DDR  DDRD
+#define BUZZER_PORT PORTD
+#define BUZZER_PIN  PD3
+
+/* ---- Laser ---------------------------------------------------------------- */
+
+/* Emissor laser em PB0, disparado pelo Timer1 (PB1/PB2 são do rádio). */
+#define LASER_DDR   DDRB
+#define LASER_PORT  PORTB
+#define LASER_PIN   PB0
+
+/* ---- Acertos e vidas ------------------------------------------------------ */
+
+/* LDR de 20 mm no ADC0 (divisor para AVcc: mais luz, leitura maior). */
+#define ADC_CH_LDR  0
+
+/* 3 LEDs de vida em PC1..PC3. */
+#define LIFE_DDR    DDRC
+#define LIFE_PORT   PORTC
+#define LIFE_MASK   (_BV(PC1) | _BV(PC2) | _BV(PC3))
+#define LIFE_SHIFT  PC1
+
+#endif /* CONFIG_H */
@@ -0,0 +1,110 @@
+#include "config.h"
+#include "gyro.h"
+#include "state.h"
+#include "twi.h"
+
+#include <util/delay.h>
+
+#define MPU_SMPLRT_DIV   0x19
+#define MPU_CONFIG       0x1A
+#define MPU_GYRO_CONFIG  0x1B
+#define MPU_GYRO_ZOUT_H  0x47
+#define MPU_PWR_MGMT_1   0x6B
+
+static int16_t rate;
+static int32_t bias_sum;
+static int16_t bias;
+static uint8_t cal_count;
+static uint8_t present;
+static uint8_t misses;
+static uint8_t fresh;
+
+/* Espera o TWI com prazo; retorna 0 se esgotou. */
+static uint8_t wait_idle(void)
+{
+    uint16_t n = GYRO_TWI_TIMEOUT_US / 10;
+
+    while (twi_busy()) {   /* wcet-loop: GYRO_TWI_TIMEOUT_US / 10 + 1 */
+        if (n-- == 0) {
+            twi_abort();
+            return 0;
+        }
+        _delay_us(10);
+    }
+    return 1;
+}
+
+static uint8_t write_wait(uint8_t reg, uint8_t value)
+{
+    if (!wait_idle() || !twi_write_reg(GYRO_I2C_ADDR, reg, value))
+        return 0;
+    return wait_idle() && twi_error() == 0;
+}
+
+uint8_t gyro_init(void)
+{
+    rate = 0;
+    bias_sum = 0;
+    bias = 0;
+    cal_count = 0;
+    misses = 0;
+    fresh = 0;
+    CAR_SET_GYRO_READ(0);
+
+    /* acorda com o PLL do giroscópio X, DLPF de 44 Hz, ±250 °/s */
+    present = write_wait(MPU_PWR_MGMT_1, 0x01) &&
+              write_wait(MPU_CONFIG, 0x03) &&
+              write_wait(MPU_SMPLRT_DIV, 0x00) &&
+              write_wait(MPU_GYRO_CONFIG, 0x00);
+    if (!present)
+        twi_abort();
+    return present;
+}
+
+/* Mais uma chamada sem leitura; esgotado o prazo, desativa o sensor. */
+static void missed(void)
+{
+    if (++misses < GYRO_STALE_POLLS)
+        return;
+    twi_abort();
+    present = 0;
+    CAR_SET_GYRO_READ(0);
+}
+
+uint8_t gyro_poll(void)
+{
+    const volatile uint8_t *rx;
+    int16_t raw;
+
+    fresh = 0;
+    if (!present)
+        return 0;
+    if (twi_busy()) {
+        missed();
+        return 0;
+    }
+
+    if (CAR_GYRO_READ() && twi_error() == 0) {
+        misses = 0;
+        rx = twi_rx();
+        raw = (int16_t)(((uint16_t)rx[0] << 8) | rx[1]);
+        if (cal_count < GYRO_CAL_SAMPLES) {
+            bias_sum += raw;
+            if (++cal_count == GYRO_CAL_SAMPLES)
+                bias = (int16_t)(bias_sum / GYRO_CAL_SAMPLES);
+        } else {
+            rate = raw - bias;
+            fresh = 1;
+        }
+    } else {
+        missed();
+        if (!present)
+            return 0;
+    }
+    CAR_SET_GYRO_READ(twi_read_regs(GYRO_I2C_ADDR, MPU_GYRO_ZOUT_H, 2));
+    return fresh;
+}
+
+int16_t gyro_rate(void)  { return rate; }
+uint8_t gyro_ready(void) { return present && cal_count >= GYRO_CAL_SAMPLES; }
+uint8_t gyro_fresh(void) { return fresh; }
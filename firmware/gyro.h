@@ -0,0 +1,44 @@
+/*
+ * Leitura do giroscópio (eixo Z do MPU-6050) pelo driver TWI.
+ *
+ * gyro_poll() é chamado a cada tick de controle: recolhe a leitura anterior,
+ * se terminou, e já dispara a próxima. Os primeiros GYRO_CAL_SAMPLES ticks
+ * (carrinho parado) estimam o bias.
+ */
+#ifndef GYRO_H
+#define GYRO_H
+
+#include <stdint.h>
+
+/* ±250 °/s -> 131 LSB por °/s. */
+#define GYRO_LSB_PER_DPS 131
+#define GYRO_CAL_SAMPLES 64
+
+/*
+ * Configura o sensor; exige interrupções ligadas. Cada escrita espera no
+ * máximo GYRO_TWI_TIMEOUT_US: sem sensor, sem pull-ups ou com interrupções
+ * desligadas retorna 0 e o giroscópio fica desativado.
+ */
+#ifndef GYRO_TWI_TIMEOUT_US
+#define GYRO_TWI_TIMEOUT_US 2000
+#endif
+
+uint8_t gyro_init(void);
+
+/*
+ * Chamadas seguidas de gyro_poll() sem leitura concluída (barramento preso,
+ * NACK do sensor) antes de desistir: o TWI é abortado e o giroscópio fica
+ * desativado, como se não existisse.
+ */
+#ifndef GYRO_STALE_POLLS
+#define GYRO_STALE_POLLS 10
+#endif
+
+/* Retorna 1 quando há uma taxa nova e calibrada. */
+uint8_t gyro_poll(void);
+
+int16_t gyro_rate(void);   /* LSB, positivo = girando para a esquerda */
+uint8_t gyro_ready(void);  /* presente e com calibração concluída */
+uint8_t gyro_fresh(void);  /* a última gyro_poll() trouxe taxa nova */
+
+#endif /* GYRO_H */
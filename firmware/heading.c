@@ -0,0 +1,78 @@
+#include "config.h"
+#include "heading.h"
+
+#if USE_GYRO
+#include "gyro.h"
+#include "twi.h"
+#endif
+
+/* Soma das taxas em LSB·tick; 1 grau = GYRO_LSB_PER_DPS · HEADING_TICK_HZ. */
+#define ACC_PER_DEG ((int32_t)GYRO_LSB_PER_DPS * HEADING_TICK_HZ)
+#define ACC_MAX     (ACC_PER_DEG * HEADING_ERR_MAX_DEG)
+
+static int32_t heading_acc;
+static int16_t err_q8;
+
+void heading_init(void)
+{
+    heading_acc = 0;
+    err_q8 = 0;
+#if USE_GYRO
+    twi_init();
+    gyro_init();
+#endif
+}
+
+#if USE_GYRO
+static int16_t clamp_trim(int32_t v)
+{
+    if (v > HEADING_TRIM_MAX)
+        return HEADING_TRIM_MAX;
+    if (v < -HEADING_TRIM_MAX)
+        return -HEADING_TRIM_MAX;
+    return (int16_t)v;
+}
+#endif
+
+int16_t heading_update(uint8_t throttle, int8_t steer)
+{
+#if USE_GYRO
+    int16_t rate;
+    int32_t trim;
+    uint8_t fresh;
+
+    fresh = gyro_poll();
+    if (!gyro_ready())
+        return 0;
+    /* sem leitura nova o erro fica parado; taxa velha não é integrada */
+    rate = fresh ? gyro_rate() : 0;
+
+    /* Curva pedida ou parado: o rumo de referência acompanha o carrinho. */
+    if (throttle == 0 || steer > HEADING_STEER_DEADBAND ||
+        steer < -HEADING_STEER_DEADBAND) {
+        heading_acc = 0;
+        err_q8 = 0;
+        return 0;
+    }
+
+    if (fresh) {
+        heading_acc += rate;
+        if (heading_acc > ACC_MAX)
+            heading_acc = ACC_MAX;
+        else if (heading_acc < -ACC_MAX)
+            heading_acc = -ACC_MAX;
+        err_q8 = (int16_t)(heading_acc * 256 / ACC_PER_DEG);
+    }
+
+    /* Desvio para a esquerda (positivo) corrige virando à direita. */
+    trim = ((int32_t)err_q8 * HEADING_KP_Q8 >> 16) +
+           ((int32_t)rate * 256 / GYRO_LSB_PER_DPS * HEADING_KD_Q8 >> 16);
+    return clamp_trim(trim);
+#else
+    (void)throttle;
+    (void)steer;
+    return 0;
+#endif
+}
+
+int16_t heading_error_q8(void) { return err_q8; }
@@ -0,0 +1,51 @@
+/*
+ * Manutenção de rumo (heading hold) em ponto fixo.
+ *
+ * Enquanto o piloto manda seguir reto, integra a taxa do giroscópio e
+ * devolve uma correção para o mixer diferencial que puxa o carrinho de
+ * volta ao rumo em que estava quando o volante foi soltado.
+ */
+#ifndef HEADING_H
+#define HEADING_H
+
+#include <stdint.h>
+
+/* Frequência de chamada de heading_update(). */
+#ifndef HEADING_TICK_HZ
+#define HEADING_TICK_HZ 100
+#endif
+/* Ganhos Q8: duty por grau de erro e por °/s de taxa. */
+#ifndef HEADING_KP_Q8
+#define HEADING_KP_Q8 (3 * 256)
+#endif
+#ifndef HEADING_KD_Q8
+#define HEADING_KD_Q8 (1 * 128)
+#endif
+#ifndef HEADING_TRIM_MAX
+#define HEADING_TRIM_MAX 60
+#endif
+/* |steer| abaixo disso conta como "reto". */
+#ifndef HEADING_STEER_DEADBAND
+#define HEADING_STEER_DEADBAND 4
+#endif
+/*
+ * Erro máximo acumulado, em graus. Empurrado ou rodado além disso, o
+ * carrinho corrige como se estivesse nesse limite (sempre no sentido
+ * certo); também mantém o erro Q8 dentro de int16.
+ */
+#ifndef HEADING_ERR_MAX_DEG
+#define HEADING_ERR_MAX_DEG 90
+#endif
+
+void heading_init(void);
+
+/*
+ * Chamar a HEADING_TICK_HZ com o comando atual do rádio. Retorna a correção
+ * (positivo = virar à direita) para pwm_mix().
+ */
+int16_t heading_update(uint8_t throttle, int8_t steer);
+
+/* Erro de rumo atual em graus Q8 (telemetria/depuração). */
+int16_t heading_error_q8(void);
+
+#endif /* HEADING_H */
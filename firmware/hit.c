@@ -0,0 +1,103 @@
+#include "config.h"
+#include "adc.h"
+#include "hit.h"
+#include "hitpush.h"
+#include "laser.h"
+#include "lives.h"
+#include "state.h"
+
+/* Amostras por largura de equipe. */
+#define SLOT ((uint16_t)LASER_PULSE_MS * HIT_SAMPLE_HZ / 1000)
+/* Acima disso não é laser: a luz ambiente mudou de patamar. */
+#define WIDTH_MAX (LASER_TEAMS * SLOT + SLOT / 2)
+/* Amostras sem LDR na janela do sensor de temperatura (adc.h). */
+#define TEMP_WINDOW ((uint8_t)((uint32_t)ADC_1V1_SETTLE_MS * HIT_SAMPLE_HZ / \
+                               1000 + 2))
+
+static uint16_t baseline_q4;   /* média móvel da luz ambiente, Q4 */
+static uint8_t width;          /* amostras do pulso atual; 0 = fora */
+static uint8_t last_team;
+
+void hit_init(void)
+{
+    adc_init();
+    DIDR0 |= _BV(ADC_CH_LDR);
+    baseline_q4 = adc_read(ADC_REF_AVCC | ADC_CH_LDR) << 4;
+    width = 0;
+}
+
+void hit_set_team(uint8_t team)
+{
+    CAR_SET_TEAMS(team != HIT_NO_TEAM);
+    team = CAR_TEAMS() ? team & (LASER_TEAMS - 1) : 0;
+    CAR_SET_TEAM(team);
+    laser_set_team(team);
+}
+
+uint8_t hit_team(void)
+{
+    return CAR_TEAMS() ? CAR_TEAM() : HIT_NO_TEAM;
+}
+
+/*
+ * Largura -> equipe: o pulso da equipe t dura (t + 1) slots, então os
+ * limites ficam no meio entre múltiplos. No máximo 4 comparações com
+ * constantes, sem divisão.
+ */
+static uint8_t classify(uint16_t w)
+{
+    uint8_t t;
+
+    w += HIT_WIDTH_BIAS;
+    if (w < SLOT / 2)
+        return 0xFF;
+    for (t = 0; t < LASER_TEAMS; t++)   /* wcet-loop: LASER_TEAMS */
+        if (w < (uint16_t)(t + 1) * SLOT + SLOT / 2)
+            return t;
+    return 0xFF;
+}
+
+enum hit_result hit_poll(void)
+{
+    uint16_t v, base;
+    uint8_t team;
+
+    /*
+     * A janela da temperatura só abre fora de pulso. Um pulso que comece
+     * dentro dela é medido curto; com uma janela por segundo é raro.
+     */
+    if (adc_window(width == 0, TEMP_WINDOW))
+        return HIT_NONE;
+    v = adc_read(ADC_REF_AVCC | ADC_CH_LDR);
+    base = baseline_q4 >> 4;
+
+    if (v > base + HIT_THRESHOLD) {
+        if (++width > WIDTH_MAX) {
+            /* a linha de base não anda durante o pulso; recomeça dela */
+            baseline_q4 = v << 4;
+            width = 0;
+            return HIT_INVALID;
+        }
+        return HIT_NONE;
+    }
+
+    /* linha de base só anda fora de pulso (constante de ~16 amostras) */
+    baseline_q4 += v - base;
+    if (width == 0)
+        return HIT_NONE;
+
+    team = classify(width);
+    width = 0;
+    /* fora do jogo não há vida a descontar nem acerto a avisar */
+    if (CAR_IS_OUT())
+        return HIT_NONE;
+    if (team == 0xFF)
+        return HIT_INVALID;
+    last_team = team;
+    if (CAR_TEAMS() && team == CAR_TEAM())
+        return HIT_FRIENDLY;
+    hitpush_hit(team, lives_hit());
+    return HIT_ENEMY;
+}
+
+uint8_t hit_last_team(void) { return last_team; }
@@ -0,0 +1,49 @@
+/*
+ * Detecção de acertos pelo LDR, com filtro de fogo amigo.
+ *
+ * Amostra o LDR a HIT_SAMPLE_HZ contra uma linha de base que acompanha a
+ * luz ambiente. Um pulso de laser é medido de ponta a ponta e a largura diz
+ * a equipe de quem atirou (ver laser.h). No jogo em equipes, pulsos da
+ * própria equipe são descartados aqui, antes de chegar nas vidas; fora
+ * dele (HIT_NO_TEAM, o padrão) todo acerto conta.
+ */
+#ifndef HIT_H
+#define HIT_H
+
+#include <stdint.h>
+
+#ifndef HIT_SAMPLE_HZ
+#define HIT_SAMPLE_HZ 200
+#endif
+/* Subida mínima sobre a linha de base para contar como laser. */
+#ifndef HIT_THRESHOLD
+#define HIT_THRESHOLD 80
+#endif
+/* Correção da largura medida pelo atraso do LDR, em amostras. */
+#ifndef HIT_WIDTH_BIAS
+#define HIT_WIDTH_BIAS 0
+#endif
+
+enum hit_result {
+    HIT_NONE = 0,
+    HIT_ENEMY,      /* vida descontada */
+    HIT_FRIENDLY,   /* mesma equipe, ignorado */
+    HIT_INVALID     /* pulso curto/longo demais */
+};
+
+void hit_init(void);
+
+/* Sem equipe: todos contra todos, o laser sai com a largura da equipe 0. */
+#define HIT_NO_TEAM 0xFF
+
+/* Equipe deste carrinho (laser, filtro e telemetria) ou HIT_NO_TEAM. */
+void hit_set_team(uint8_t team);
+uint8_t hit_team(void);
+
+/* Chamar a HIT_SAMPLE_HZ. */
+enum hit_result hit_poll(void);
+
+/* Equipe do último pulso válido. */
+uint8_t hit_last_team(void);
+
+#endif /* HIT_H */
@@ -0,0 +1,48 @@
+#include "config.h"
+#include "command.h"
+#include "hitpush.h"
+#include "nrf24.h"
+
+static uint8_t event[EVT_HIT_SIZE];
+static uint8_t seq;
+static uint8_t repeats;
+
+static void load(void)
+{
+    nrf24_flush_tx();
+    nrf24_write_ack(CMD_PIPE_PRIVATE, event, EVT_HIT_SIZE);
+}
+
+void hitpush_hit(uint8_t shooter_team, uint8_t lives)
+{
+    seq = (uint8_t)(seq == 255 ? 1 : seq + 1);
+    event[0] = EVT_HIT;
+    event[1] = seq;
+    event[2] = shooter_team;
+    event[3] = lives;
+    load();
+    repeats = HITPUSH_REPEATS;
+}
+
+uint8_t hitpush_on_rx(void)
+{
+    if (repeats == 0)
+        return 0;
+    if (--repeats == 0)
+        return 0;
+    load();
+    return 1;
+}
+
+uint8_t hitpush_decode(const uint8_t *pkt, uint8_t len, struct hit_event *evt,
+                       uint8_t *last_seq)
+{
+    if (len < EVT_HIT_SIZE || pkt[0] != EVT_HIT || pkt[1] == 0 ||
+        pkt[1] == *last_seq)
+        return 0;
+    *last_seq = pkt[1];
+    evt->seq = pkt[1];
+    evt->shooter_team = pkt[2];
+    evt->lives = pkt[3];
+    return 1;
+}
@@ -0,0 +1,48 @@
+/*
+ * Aviso de acerto para o transmissor no payload do ACK.
+ *
+ * Ao ser atingido, o carrinho descarta o que estava na fila de ACK (só
+ * telemetria, que se recupera sozinha) e coloca o evento, que sai no ACK
+ * do próximo comando recebido. O mesmo evento vai em HITPUSH_REPEATS ACKs
+ * seguidos, caso algum se perca; o transmissor descarta repetições pelo
+ * seq. Latência total: fim do pulso + uma amostra do LDR + um período de
+ * comando do transmissor.
+ *
+ * Em grupo os comandos chegam sem ACK; o evento sai no ACK do próximo
+ * CMD_POLL que o transmissor mandar a este carrinho (command.h), então a
+ * latência passa a ser a do rodízio de consultas.
+ *
+ *   [EVT_HIT] [seq] [equipe do atirador] [vidas restantes]
+ */
+#ifndef HITPUSH_H
+#define HITPUSH_H
+
+#include <stdint.h>
+
+#define EVT_HIT 0x30
+#define EVT_HIT_SIZE 4
+
+#ifndef HITPUSH_REPEATS
+#define HITPUSH_REPEATS 3
+#endif
+
+struct hit_event {
+    uint8_t seq;
+    uint8_t shooter_team;
+    uint8_t lives;
+};
+
+/* Lado do carrinho: novo acerto, vai no próximo ACK. */
+void hitpush_hit(uint8_t shooter_team, uint8_t lives);
+
+/*
+ * Chamar após cada pacote recebido no pipe privado. Retorna 1 se recarregou
+ * o evento no ACK (não carregar telemetria desta vez).
+ */
+uint8_t hitpush_on_rx(void);
+
+/* Lado do transmissor: retorna 1 se o payload do ACK é um evento novo. */
+uint8_t hitpush_decode(const uint8_t *pkt, uint8_t len, struct hit_event *evt,
+                       uint8_t *last_seq);
+
+#endif /* HITPUSH_H */
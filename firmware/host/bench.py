@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""
+Benchmarks do firmware num Linux comum, com resultado em JSON e comparação
+contra a linha de base (host/bench_baseline.json).
+
+  telemetria  bytes por registro no fluxo de test/telemetry_test.c
+  pwm         eficiência e erro do estágio de potência no modo padrão
+              (MOTOR_PWM_DEFAULT), de host/pwm_model.c
+  energia     energia, 5 V mínimo e resets por brownout numa partida, de
+              host/power_model.c com os valores padrão
+  latência    pior caso do comando até o PWM e do pulso do laser até o
+              aviso no transmissor, pelas constantes do firmware
+  boot        do reset ao rádio pronto, somando as esperas do boot
+  ISRs        ciclos de pior caso de cada ISR e do quadro, de host/wcet.py;
+              só com o ELF do avr-gcc (senão ficam de fora do resultado)
+
+Latência e boot são calculados, não medidos: não há emulador de AVR no
+repositório. A entrega do rádio com vários carrinhos fica de fora pelo
+mesmo motivo.
+
+Cada métrica tem um sentido (menor ou maior é melhor) e uma tolerância na
+unidade dela. Sai com 1 se alguma piorou além da tolerância; com --update
+regrava a linha de base com os valores atuais.
+
+    make bench
+    host/bench.py --build build [--elf build/carrinho.elf] [--out F] [--update]
+"""
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+FIRMWARE = os.path.dirname(HERE)
+BASELINE = os.path.join(HERE, 'bench_baseline.json')
+
+sys.dont_write_bytecode = True
+sys.path.insert(0, HERE)
+import wcet  # noqa: E402  (#defines do firmware e --json)
+
+# Comandos do transmissor por segundo, para o aviso de acerto no ACK.
+CMD_HZ = 50
+
+
+def run(cmd):
+    r = subprocess.run(cmd, stdout=subprocess.PIPE, universal_newlines=True)
+    if r.returncode != 0:
+        sys.exit('bench: %s saiu com %d' % (cmd[0], r.returncode))
+    return r.stdout
+
+
+def source(name):
+    with open(os.path.join(FIRMWARE, name), encoding='utf-8') as f:
+        return f.read()
+
+
+def default_mode():
+    """Nome e período em ciclos do modo de MOTOR_PWM_DEFAULT (pwm.h)."""
+    m = re.search(r'#define\s+MOTOR_PWM_DEFAULT\s+PWM_FREQ_(\w+)',
+                  source('config.h'))
+    for name, phase, div in re.findall(r'X\((\w+),\s*(\d),\s*(\d+)\)',
+                                       source('pwm.h')):
+        if name == m.group(1):
+            return name, int(div) * (510 if phase == '1' else 256)
+    sys.exit('bench: modo %s não está em PWM_MODES' % m.group(1))
+
+
+def telemetry(build, out):
+    m = re.search(r'fluxo: ([\d.]+) bytes/registro',
+                  run([os.path.join(build, 'host', 'telemetry_test')]))
+    out['telemetria.bytes_por_registro'] = float(m.group(1))
+
+
+def pwm(build, out, mode):
+    m = re.search(r'PWM_FREQ_%s\s+ef\s+([\d.]+)%%\s+erro máx\s+([\d.]+)%%'
+                  % mode, run([os.path.join(build, 'host', 'pwm_model')]))
+    out['pwm.eficiencia_pct'] = float(m.group(1))
+    out['pwm.erro_duty_pct'] = float(m.group(2))
+
+
+def power(build, out):
+    text = run([os.path.join(build, 'host', 'power_model'), 'partidas=1'])
+    m = re.search(r'^1\s+\S+\s+\S+\s+([\d.]+)\s+([\d.]+)\s+([\d.]+)\s+'
+                  r'([\d.]+)\s+(\d+)\s+(\d+)\s+([\d.]+)\s+([\d.]+)$',
+                  text, re.M)
+    out['energia.mwh_por_partida'] = float(m.group(8))
+    out['energia.v5_min'] = float(m.group(2))
+    out['energia.resets_por_partida'] = int(m.group(5))
+
+
+def timing(out, period):
+    d = wcet.defines()
+    f_cpu = d['F_CPU']
+    tick = 1000.0 / d['SCHED_HZ']
+
+    # pacote logo depois de radio_poll(): espera o quadro (até um tick,
+    # conferido por make wcet), o próximo task_100hz (dois ticks) e o
+    # OCR0x valendo no próximo período do Timer0
+    out['latencia.cmd_pwm_ms'] = round(3 * tick + period * 1e3 / f_cpu, 3)
+
+    # hitpush.h: pulso da equipe 0 + uma amostra do LDR + um comando
+    out['latencia.acerto_ms'] = round(
+        d['LASER_PULSE_MS'] + 1000.0 / d['HIT_SAMPLE_HZ'] + 1000.0 / CMD_HZ,
+        3)
+
+    # cristal (16K CK + 65 ms), referência de 1,1 V em thermal_init(),
+    # esperas de nrf24_init() e a varredura de canais
+    nrf = sum(int(x) for x in re.findall(r'_delay_ms\((\d+)\)',
+                                          source('nrf24.c')))
+    scan = (d['CHANSCAN_PASSES'] * d['NRF_CHANNELS'] *
+            d['CHANSCAN_DWELL_US'] / 1000.0)
+    out['boot.ms'] = round(16384e3 / f_cpu + 65 + d['ADC_1V1_SETTLE_MS'] +
+                           nrf + scan, 3)
+
+
+def isrs(out, elf, objdump):
+    r = subprocess.run([sys.executable, os.path.join(HERE, 'wcet.py'),
+                        '--objdump', objdump, '--json', elf],
+                       stdout=subprocess.PIPE, universal_newlines=True)
+    if r.returncode not in (0, 1) or not r.stdout.strip():
+        sys.exit('bench: wcet.py falhou')
+    for row in json.loads(r.stdout)['linhas']:
+        key = re.sub(r'\W+', '_', row['item'].lower()).strip('_')
+        out['wcet.%s_ciclos' % key] = row['ciclos']
+
+
+def compare(values, base):
+    worse = []
+    print('%-34s %12s %12s %8s' % ('', 'atual', 'base', 'tol'))
+    for key in sorted(values):
+        v = values[key]
+        b = base.get(key)
+        if b is None:
+            print('%-34s %12g %12s %8s  nova' % (key, v, '-', '-'))
+            continue
+        lim = b['tol']
+        bad = (v > b['valor'] + lim if b['melhor'] == 'menor'
+               else v < b['valor'] - lim)
+        print('%-34s %12g %12g %8g  %s' % (key, v, b['valor'], lim,
+                                           'PIOROU' if bad else 'ok'))
+        if bad:
+            worse.append(key)
+    return worse
+
+
+# Sentido e tolerância padrão das métricas novas na linha de base.
+DEFAULTS = {
+    'pwm.eficiencia_pct': ('maior', 0.5),
+    'energia.v5_min': ('maior', 0.05),
+}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+    ap.add_argument('--build', default=os.path.join(FIRMWARE, 'build'))
+    ap.add_argument('--elf')
+    ap.add_argument('--objdump', default='avr-objdump')
+    ap.add_argument('--out')
+    ap.add_argument('--baseline', default=BASELINE)
+    ap.add_argument('--update', action='store_true')
+    args = ap.parse_args()
+
+    mode, period = default_mode()
+    values = {}
+    telemetry(args.build, values)
+    pwm(args.build, values, mode)
+    power(args.build, values)
+    timing(values, period)
+    if args.elf:
+        isrs(values, args.elf, args.objdump)
+
+    result = {'modo_pwm': mode, 'elf': bool(args.elf), 'metricas': values}
+    out = args.out or os.path.join(args.build, 'bench.json')
+    with open(out, 'w') as f:
+        json.dump(result, f, indent=1, sort_keys=True)
+        f.write('\n')
+
+    base = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            base = json.load(f)
+    if args.update:
+        for key, v in values.items():
+            old = base.get(key, {})
+            best, tol = DEFAULTS.get(key, ('menor', 0))
+            base[key] = dict(valor=v, melhor=old.get('melhor', best),
+                             tol=old.get('tol', tol or round(abs(v) * 0.05, 3)))
+        with open(args.baseline, 'w') as f:
+            json.dump(base, f, indent=1, sort_keys=True)
+            f.write('\n')
+        print('linha de base atualizada: %s' % args.baseline)
+        return 0
+
+    worse = compare(values, base)
+    print('\nresultado em %s' % out)
+    if worse:
+        print('piorou: %s' % ', '.join(worse))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,560 @@
+/*
+ * Modelo elétrico da alimentação do carrinho, rodando no host: prevê o
+ * mínimo dos trilhos de lógica e os resets por brownout numa sequência de
+ * partidas simuladas.
+ *
+ *   bateria      PP3 recarregável de NiMH: tensão em aberto pelo estado de
+ *                carga, resistência interna (sobe no fim da carga) e
+ *                polarização RC; carga contada em coulombs
+ *   entrada      capacitor de filtragem depois da bateria, de onde saem os
+ *                motores, o coletor dos optos e o regulador de 5 V
+ *   reguladores  lineares em cascata: 5 V (7805) para o ATmega e periféricos,
+ *                3,3 V (AMS1117) a partir dos 5 V para o nRF24L01; cada um
+ *                com dropout, corrente quiescente, limite de corrente e
+ *                capacitor de saída. Sem folga o regulador para de conduzir
+ *                e o capacitor segura a carga sozinho
+ *   motores      os mesmos R, L, FCEM e carga (i0 + g * E) de pwm_model.c,
+ *                mais uma constante de tempo mecânica: partindo parado a
+ *                corrente é a de rotor travado. Chave ideal com Rds(on) e
+ *                diodo de roda livre, no período do modo de PWM_MODES
+ *   lógica       ATmega, LEDs de vida, laser (período, pulso, pente e recarga
+ *                de laser.h), buzzer depois de cada acerto e LEDs dos optos
+ *   rádio        RX contínuo e rajada de TX do ACK a cada comando
+ *
+ * A partida é um roteiro pseudoaleatório (semente fixa) de trechos de
+ * aceleração, curva e parada, com alguns acertos. Os 5 V abaixo do BOD
+ * resetam o ATmega: pinos soltos (motores e laser desligados) até os 5 V
+ * voltarem acima do BOD mais a histerese e passarem a partida do cristal e o
+ * boot do firmware; as vidas voltam a LIVES_MAX, como no firmware. Os 3,3 V
+ * abaixo do mínimo do nRF24L01 contam como reset do rádio.
+ *
+ * Relata por partida a carga, os mínimos dos trilhos, o pico de corrente,
+ * os resets e a energia tirada da bateria; lista os primeiros brownouts com
+ * o duty do momento.
+ *
+ *   make power
+ *   make power ARGS="cbulk=2200 rampa=200"
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "laser.h"
+#include "lives.h"
+#include "pwm.h"
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+struct params {
+    double cells;      /* elementos de NiMH em série */
+    double cap_mah;
+    double soc0;       /* carga no início da primeira partida, 0..1 */
+    double socmin;     /* para de simular abaixo disto */
+    double rint;       /* ohm, bateria carregada */
+    double rp;         /* ohm, polarização */
+    double tp;         /* s, constante de tempo da polarização */
+    double cbulk_uf;   /* entrada dos reguladores */
+    double drop5;      /* V, dropout do 7805 */
+    double iq5_ma;
+    double c5_uf;
+    double drop3;      /* V, dropout do AMS1117 */
+    double iq3_ma;
+    double c3_uf;
+    double ilim;       /* A, limite de corrente dos reguladores */
+    double bod;        /* V, BODLEVEL (4,3 V para 16 MHz) */
+    double vnrf;       /* V, mínimo do nRF24L01 */
+    double mcu_ma;
+    double led_ma;     /* por LED de vida aceso */
+    double laser_ma;
+    double buzzer_ma;
+    double opto_ma;    /* LED do opto, no pino do PWM */
+    double drive_ma;   /* coletor do opto / RGS, da bateria, chave ligada */
+    double rx_ma;
+    double tx_ma;      /* 11,3 mA a 0 dBm; módulos com PA passam de 100 mA */
+    double tx_us;      /* rajada do ACK */
+    double cmd_hz;     /* comandos do transmissor por segundo */
+    double r;          /* ohm, motor */
+    double l_uh;
+    double i0;         /* A, corrente em vazio */
+    double g;          /* A/V, carga viscosa: I = i0 + g * E */
+    double tm;         /* s, constante de tempo mecânica */
+    double rds_mohm;
+    double vf;         /* diodo de roda livre */
+    double mode;       /* índice em PWM_MODES (MOTOR_PWM_DEFAULT) */
+    double match_s;
+    double matches;    /* máximo de partidas */
+    double hits;       /* acertos sofridos por partida */
+    double boot_s;     /* do fim da partida do cristal até o PWM voltar */
+    double ramp_ms;    /* rampa de 0 a 255 no duty; o firmware não tem (0) */
+    double seed;
+};
+
+static struct params p = {
+    .cells = 7, .cap_mah = 200, .soc0 = 1.0, .socmin = 0.05,
+    .rint = 1.2, .rp = 0.4, .tp = 30.0, .cbulk_uf = 470,
+    .drop5 = 2.0, .iq5_ma = 5.0, .c5_uf = 100,
+    .drop3 = 1.1, .iq3_ma = 5.0, .c3_uf = 10, .ilim = 1.0,
+    .bod = 4.3, .vnrf = 1.9,
+    .mcu_ma = 15, .led_ma = 10, .laser_ma = 30, .buzzer_ma = 30,
+    .opto_ma = 10, .drive_ma = 5,
+    .rx_ma = 13.5, .tx_ma = 11.3, .tx_us = 250, .cmd_hz = 50,
+    .r = 3.0, .l_uh = 200.0, .i0 = 0.2, .g = 0.055, .tm = 0.08,
+    .rds_mohm = 25.0, .vf = 0.5,
+    .mode = PWM_FREQ_977, .match_s = 180, .matches = 20, .hits = 2,
+    .boot_s = 0.3, .ramp_ms = 0, .seed = 1,
+};
+
+static const struct {
+    const char *name;
+    double *v;
+} args[] = {
+    { "cells", &p.cells }, { "cap", &p.cap_mah }, { "soc", &p.soc0 },
+    { "socmin", &p.socmin }, { "rint", &p.rint }, { "rp", &p.rp },
+    { "tp", &p.tp }, { "cbulk", &p.cbulk_uf }, { "drop5", &p.drop5 },
+    { "iq5", &p.iq5_ma }, { "c5", &p.c5_uf }, { "drop3", &p.drop3 },
+    { "iq3", &p.iq3_ma }, { "c3", &p.c3_uf }, { "ilim", &p.ilim },
+    { "bod", &p.bod }, { "vnrf", &p.vnrf }, { "mcu", &p.mcu_ma },
+    { "led", &p.led_ma }, { "laser", &p.laser_ma },
+    { "buzzer", &p.buzzer_ma }, { "opto", &p.opto_ma },
+    { "drive", &p.drive_ma }, { "rx", &p.rx_ma }, { "tx", &p.tx_ma },
+    { "txus", &p.tx_us }, { "cmdhz", &p.cmd_hz }, { "r", &p.r },
+    { "l", &p.l_uh }, { "i0", &p.i0 }, { "g", &p.g }, { "tm", &p.tm },
+    { "rds", &p.rds_mohm }, { "vf", &p.vf }, { "modo", &p.mode },
+    { "partida", &p.match_s }, { "partidas", &p.matches },
+    { "acertos", &p.hits }, { "boot", &p.boot_s }, { "rampa", &p.ramp_ms },
+    { "semente", &p.seed },
+};
+
+#define MODE_ENTRY(name, phase, div) { #name, phase, div },
+static const struct {
+    const char *name;
+    int phase;
+    int div;
+} modes[PWM_FREQ_COUNT] = {
+    PWM_MODES(MODE_ENTRY)
+};
+#undef MODE_ENTRY
+
+/* Tensão em aberto de um elemento de NiMH pelo estado de carga. */
+static const struct {
+    double soc;
+    double v;
+} ocv_table[] = {
+    { 0.00, 1.00 }, { 0.05, 1.15 }, { 0.10, 1.20 }, { 0.20, 1.23 },
+    { 0.50, 1.26 }, { 0.80, 1.30 }, { 0.90, 1.33 }, { 1.00, 1.40 },
+};
+#define OCV_COUNT (sizeof(ocv_table) / sizeof(ocv_table[0]))
+
+/* Resistência interna no fim da carga, em múltiplos de rint. */
+#define RINT_EMPTY   3.0
+#define RINT_KNEE    0.2
+
+/* Histerese do BOD e partida do cristal (CKSEL/SUT: 16K CK + 65 ms). */
+#define BOD_HYST     0.05
+#define XTAL_START_S (16384.0 / F_CPU + 0.065)
+
+/* Melodia de acerto do buzzer, aproximada. */
+#define BUZZ_S       0.3
+
+/* Trechos do roteiro: duração de 0,5 s a 3 s, aceleração e curva. */
+static const unsigned char throttles[] = { 0, 0, 96, 160, 255, 255 };
+#define THROTTLE_COUNT (sizeof(throttles) / sizeof(throttles[0]))
+#define IDLE_START_S 2.0
+
+/* Passo máximo; as bordas do PWM e das rajadas de TX caem em passo exato. */
+#define DT_MAX       10e-6
+
+#define EVENTS_SHOWN 10
+
+static uint32_t rng;
+
+static uint32_t rnd(void)
+{
+    rng = rng * 1103515245u + 12345u;
+    return rng >> 16;
+}
+
+static double ocv(double soc)
+{
+    size_t n;
+
+    if (soc <= ocv_table[0].soc)
+        return p.cells * ocv_table[0].v;
+    for (n = 1; n < OCV_COUNT; n++) {
+        if (soc <= ocv_table[n].soc) {
+            double f = (soc - ocv_table[n - 1].soc) /
+                       (ocv_table[n].soc - ocv_table[n - 1].soc);
+
+            return p.cells * (ocv_table[n - 1].v +
+                              f * (ocv_table[n].v - ocv_table[n - 1].v));
+        }
+    }
+    return p.cells * ocv_table[OCV_COUNT - 1].v;
+}
+
+static double rint_at(double soc)
+{
+    if (soc >= RINT_KNEE)
+        return p.rint;
+    if (soc < 0.0)
+        soc = 0.0;
+    return p.rint * (1.0 + (RINT_EMPTY - 1.0) * (RINT_KNEE - soc) / RINT_KNEE);
+}
+
+/* Fração do período com o pino OC0x alto (duty 0 desliga a saída). */
+static double pin_duty(uint8_t ocr)
+{
+    if (ocr == 0)
+        return 0.0;
+    if (modes[(int)p.mode].phase)
+        return ocr / 255.0;
+    return (ocr + 1) / 256.0;
+}
+
+struct motor {
+    double i;          /* A */
+    double e;          /* V, FCEM */
+    double duty;       /* aplicado, com a rampa */
+};
+
+/* Avança um motor dt segundos; devolve a corrente média tirada da entrada. */
+static double motor_step(struct motor *m, int on, double vin, double dt)
+{
+    const double l = p.l_uh * 1e-6, rds = p.rds_mohm * 1e-3;
+    double iinf, i1, ir, load;
+
+    if (on) {
+        iinf = (vin - m->e) / (p.r + rds);
+        i1 = iinf + (m->i - iinf) * exp(-dt * (p.r + rds) / l);
+    } else if (m->i > 0.0) {
+        iinf = (-p.vf - m->e) / p.r;
+        i1 = iinf + (m->i - iinf) * exp(-dt * p.r / l);
+    } else {
+        i1 = 0.0;
+    }
+    if (i1 < 0.0)
+        i1 = 0.0;
+    ir = 0.5 * (m->i + i1);
+    m->i = i1;
+
+    /* mecânica: a corrente que sobra da carga acelera o eixo */
+    load = p.i0 + p.g * m->e;
+    if (m->e <= 0.0 && ir <= p.i0) {
+        m->e = 0.0;
+    } else {
+        m->e += dt * (ir - load) / (p.g * p.tm);
+        if (m->e < 0.0)
+            m->e = 0.0;
+    }
+    return on ? ir : 0.0;
+}
+
+/*
+ * Regulador linear sobre o capacitor de saída: segue min(vset, vin - drop)
+ * enquanto o limite de corrente deixa; sem folga não conduz. Devolve a
+ * corrente que tira da entrada (sem a quiescente).
+ */
+static double regulate(double *v, double vset, double vin, double drop,
+                       double iload, double c, double dt)
+{
+    double vt = vin - drop < vset ? vin - drop : vset, ireg = 0.0;
+
+    if (vt >= *v) {
+        ireg = iload + c * (vt - *v) / dt;
+        if (ireg > p.ilim)
+            ireg = p.ilim;
+    }
+    *v += (ireg - iload) * dt / c;
+    if (*v < 0.0)
+        *v = 0.0;
+    return ireg;
+}
+
+enum mcu_state { MCU_RUN, MCU_RESET, MCU_BOOT };
+
+struct event {
+    int match;
+    double t;
+    uint8_t left, right;
+    double vin;
+};
+
+struct match_result {
+    double soc0, soc1;
+    double vin_min, v5_min, v3_min;
+    double ib_max;
+    double energy;     /* J */
+    double t_reset;    /* s fora do ar por brownout */
+    int resets, radio_resets;
+};
+
+static struct event events[EVENTS_SHOWN];
+static int event_count;
+
+/* Estado que atravessa as partidas: bateria e trilhos. */
+static double soc, vp, vin, v5, v3;
+
+static void simulate(int match, struct match_result *res)
+{
+    const double T = modes[(int)p.mode].div *
+                     (modes[(int)p.mode].phase ? 510.0 : 256.0) / F_CPU;
+    const double cb = p.cbulk_uf * 1e-6, c5 = p.c5_uf * 1e-6,
+                 c3 = p.c3_uf * 1e-6;
+    const double cmd_t = 1.0 / p.cmd_hz, tx_t = p.tx_us * 1e-6;
+    const double ramp = p.ramp_ms > 0.0 ? 255.0 * T / (p.ramp_ms * 1e-3)
+                                        : 256.0;
+    struct motor ml = { 0 }, mr = { 0 };
+    enum mcu_state mcu = MCU_RUN;
+    double t = 0.0, seg_end = IDLE_START_S, boot_left = 0.0, t_boot = 0.0;
+    double buzz_end = -1.0, next_hit;
+    uint8_t want_l = 0, want_r = 0;
+    int lives = LIVES_MAX, hits_done = 0, nrf_low = 0;
+
+    rng = (uint32_t)p.seed * 7919u + (uint32_t)match;
+    memset(res, 0, sizeof(*res));
+    res->soc0 = soc;
+    res->vin_min = vin;
+    res->v5_min = v5;
+    res->v3_min = v3;
+    next_hit = p.hits > 0 ? p.match_s / (p.hits + 1) : p.match_s + 1.0;
+
+    while (t < p.match_s) {
+        int run = mcu == MCU_RUN, laser_on = 0;
+        double ph, dl, dr, i5_fixed, r, voc;
+
+        /* roteiro: um trecho novo quando o anterior acaba */
+        if (t >= seg_end) {
+            uint8_t thr = throttles[rnd() % THROTTLE_COUNT];
+
+            want_l = want_r = thr;
+            switch (rnd() % 3) {
+            case 1: want_l = thr / 4; break;
+            case 2: want_r = thr / 4; break;
+            }
+            seg_end = t + 0.5 + (rnd() % 26) * 0.1;
+        }
+        if (t >= next_hit) {
+            hits_done++;
+            next_hit = hits_done < p.hits
+                       ? p.match_s * (hits_done + 1) / (p.hits + 1)
+                       : p.match_s + 1.0;
+            if (run && lives > 0) {
+                lives--;
+                buzz_end = t + BUZZ_S;
+            }
+        }
+
+        /* rampa opcional e pinos soltos fora do RUN */
+        if (!run || lives == 0) {
+            ml.duty = mr.duty = 0.0;
+        } else {
+            /* só a subida tem rampa: soltar o duty não puxa corrente */
+            ml.duty = want_l > ml.duty + ramp ? ml.duty + ramp : want_l;
+            mr.duty = want_r > mr.duty + ramp ? mr.duty + ramp : want_r;
+        }
+        dl = pin_duty((uint8_t)ml.duty) * T;
+        dr = pin_duty((uint8_t)mr.duty) * T;
+
+        if (run && lives > 0) {
+            /* laser.c: pulso no início do período, pente e recarga */
+            const double lp = LASER_PERIOD_MS * 1e-3;
+            const long k = (long)((t - t_boot) / lp);
+
+            laser_on = k % (LASER_MAGAZINE + LASER_RELOAD_PERIODS) <
+                       LASER_MAGAZINE &&
+                       t - t_boot - k * lp < LASER_PULSE_MS * 1e-3;
+        }
+        i5_fixed = p.mcu_ma * 1e-3;
+        if (run) {
+            i5_fixed += lives * p.led_ma * 1e-3;
+            if (laser_on)
+                i5_fixed += p.laser_ma * 1e-3;
+            if (t < buzz_end)
+                i5_fixed += p.buzzer_ma * 1e-3;
+        }
+
+        /* a carga anda devagar: curva da bateria uma vez por período */
+        r = rint_at(soc);
+        voc = ocv(soc);
+
+        /* um período do PWM, com passo exato nas bordas */
+        for (ph = 0.0; ph < T - 1e-12;) {
+            double dt = T - ph, edge, tc, i3, i5, iin, ib, vs, vnew;
+            int onl, onr, tx;
+
+            if (ph < dl && dl - ph < dt)
+                dt = dl - ph;
+            if (ph < dr && dr - ph < dt)
+                dt = dr - ph;
+            tc = fmod(t + ph, cmd_t);
+            edge = tc < tx_t ? tx_t - tc : cmd_t - tc;
+            if (edge < dt)
+                dt = edge;
+            if (dt > DT_MAX)
+                dt = DT_MAX;
+            if (dt < 1e-9)
+                dt = 1e-9;
+
+            onl = run && ph < dl;
+            onr = run && ph < dr;
+            tx = tc < tx_t;
+
+            i3 = (tx ? p.tx_ma : p.rx_ma) * 1e-3;
+            i5 = i5_fixed + (onl + onr) * p.opto_ma * 1e-3 +
+                 regulate(&v3, 3.3, v5, p.drop3, i3, c3, dt) +
+                 p.iq3_ma * 1e-3;
+            iin = motor_step(&ml, onl, vin, dt) + motor_step(&mr, onr, vin, dt) +
+                  (onl + onr) * p.drive_ma * 1e-3 +
+                  regulate(&v5, 5.0, vin, p.drop5, i5, c5, dt) +
+                  p.iq5_ma * 1e-3;
+
+            /* entrada: Euler implícito, estável para qualquer cbulk */
+            vs = voc - vp;
+            vnew = (vin + dt / cb * (vs / r - iin)) / (1.0 + dt / (cb * r));
+            ib = (vs - vnew) / r;
+            vin = vnew;
+            vp += dt * (ib - vp / p.rp) / (p.tp / p.rp);
+            soc -= ib * dt / (p.cap_mah * 3.6);
+            res->energy += (vs - ib * r) * ib * dt;
+
+            if (vin < res->vin_min)
+                res->vin_min = vin;
+            if (v5 < res->v5_min)
+                res->v5_min = v5;
+            if (v3 < res->v3_min)
+                res->v3_min = v3;
+            if (ib > res->ib_max)
+                res->ib_max = ib;
+            if (mcu != MCU_RUN)
+                res->t_reset += dt;
+
+            if (v3 < p.vnrf && !nrf_low) {
+                nrf_low = 1;
+                res->radio_resets++;
+            } else if (v3 >= p.vnrf + BOD_HYST) {
+                nrf_low = 0;
+            }
+
+            if (mcu != MCU_RESET && v5 < p.bod) {
+                if (event_count < EVENTS_SHOWN) {
+                    struct event *ev = &events[event_count];
+
+                    ev->match = match;
+                    ev->t = t + ph;
+                    ev->left = want_l;
+                    ev->right = want_r;
+                    ev->vin = vin;
+                }
+                event_count++;
+                res->resets++;
+                mcu = MCU_RESET;
+                run = 0;
+                lives = LIVES_MAX;
+                buzz_end = -1.0;
+            } else if (mcu == MCU_RESET && v5 >= p.bod + BOD_HYST) {
+                mcu = MCU_BOOT;
+                boot_left = XTAL_START_S + p.boot_s;
+            } else if (mcu == MCU_BOOT) {
+                boot_left -= dt;
+                if (boot_left <= 0.0) {
+                    mcu = MCU_RUN;
+                    t_boot = t + ph;
+                }
+            }
+            ph += dt;
+        }
+        t += T;
+    }
+    res->soc1 = soc;
+}
+
+static void usage(void)
+{
+    size_t n;
+
+    fprintf(stderr, "uso: power_model [nome=valor ...]\nparâmetros:");
+    for (n = 0; n < sizeof(args) / sizeof(args[0]); n++)
+        fprintf(stderr, " %s=%g", args[n].name, *args[n].v);
+    fprintf(stderr, "\nmodos:");
+    for (n = 0; n < PWM_FREQ_COUNT; n++)
+        fprintf(stderr, " %zu=%s", n, modes[n].name);
+    fprintf(stderr, "\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    struct match_result r;
+    int a, m, total = 0, radio = 0, first = 0;
+    double v5_min = 5.0, v3_min = 3.3;
+    size_t n;
+
+    for (a = 1; a < argc; a++) {
+        const char *eq = strchr(argv[a], '=');
+
+        for (n = 0; eq && n < sizeof(args) / sizeof(args[0]); n++) {
+            if (strlen(args[n].name) == (size_t)(eq - argv[a]) &&
+                strncmp(argv[a], args[n].name, eq - argv[a]) == 0) {
+                *args[n].v = atof(eq + 1);
+                break;
+            }
+        }
+        if (!eq || n == sizeof(args) / sizeof(args[0]))
+            usage();
+    }
+    if ((int)p.mode < 0 || (int)p.mode >= PWM_FREQ_COUNT ||
+        p.cbulk_uf <= 0 || p.c5_uf <= 0 || p.c3_uf <= 0 || p.cmd_hz <= 0)
+        usage();
+
+    printf("NiMH %.0fx, %.0f mAh, Rint %.2f ohm, entrada %.0f uF, "
+           "7805 + AMS1117, BOD %.1f V\n"
+           "PWM_FREQ_%s, partida %.0f s, %.0f acerto(s), rampa %.0f ms\n\n",
+           p.cells, p.cap_mah, p.rint, p.cbulk_uf, p.bod,
+           modes[(int)p.mode].name, p.match_s, p.hits, p.ramp_ms);
+    printf("%-7s %5s %5s %6s %6s %6s %6s %6s %6s %7s %7s\n",
+           "partida", "SoC0", "SoC1", "Vin", "V5", "V3.3", "Ipico",
+           "resets", "rádio", "fora(s)", "E(mWh)");
+
+    soc = p.soc0;
+    vp = 0.0;
+    vin = ocv(soc);
+    v5 = vin - p.drop5 < 5.0 ? vin - p.drop5 : 5.0;
+    v3 = v5 - p.drop3 < 3.3 ? v5 - p.drop3 : 3.3;
+
+    for (m = 1; m <= p.matches && soc > p.socmin; m++) {
+        simulate(m, &r);
+        printf("%-7d %4.0f%% %4.0f%% %6.2f %6.2f %6.2f %6.2f %6d %6d "
+               "%7.1f %7.1f\n", m, r.soc0 * 100, r.soc1 * 100, r.vin_min,
+               r.v5_min, r.v3_min, r.ib_max, r.resets, r.radio_resets,
+               r.t_reset, r.energy / 3.6);
+        if (r.resets && !first)
+            first = m;
+        total += r.resets;
+        radio += r.radio_resets;
+        if (r.v5_min < v5_min)
+            v5_min = r.v5_min;
+        if (r.v3_min < v3_min)
+            v3_min = r.v3_min;
+    }
+
+    printf("\n");
+    for (a = 0; a < event_count && a < EVENTS_SHOWN; a++)
+        printf("  brownout: partida %d, t %7.3f s, duty %3d/%3d, "
+               "entrada %.2f V\n", events[a].match, events[a].t,
+               events[a].left, events[a].right, events[a].vin);
+    if (event_count > EVENTS_SHOWN)
+        printf("  ... e mais %d\n", event_count - EVENTS_SHOWN);
+    if (total)
+        printf("%d reset(s) por brownout, o primeiro na partida %d; "
+               "5 V mínimo %.2f V\n", total, first, v5_min);
+    else
+        printf("sem brownout; folga mínima até o BOD %.2f V\n",
+               v5_min - p.bod);
+    if (radio)
+        printf("%d queda(s) do nRF24L01 abaixo de %.1f V (3,3 V mínimo "
+               "%.2f V)\n", radio, p.vnrf, v3_min);
+    return 0;
+}
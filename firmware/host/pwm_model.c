@@ -0,0 +1,466 @@
+/*
+ * Modelo elétrico do estágio de potência dos motores, rodando no host.
+ *
+ * Para cada modo de PWM_MODES (pwm.h) e cada duty, a forma de onda do pino
+ * OC0A sai da contagem do Timer0 feita como no hardware (fast PWM ou
+ * phase-correct, com o desligamento em duty 0 de pwm.c) e passa por:
+ *
+ *   optoacoplador  atrasos de subida/descida; saída em seguidor de emissor
+ *                  que carrega o gate com CTR * IF; RGS descarrega o gate
+ *   IRLZ44N        carga de gate em três trechos (Qgs até o platô, platô de
+ *                  Miller Qgd proporcional a Vbat, resto até Qg a 5 V) e
+ *                  Rds(on) conforme Vgs
+ *   motor          R + L + força contraeletromotriz, diodo de roda livre
+ *
+ * A FCEM de regime sai por bisseção, igualando a corrente média simulada à
+ * da carga (i0 + g * E). O mesmo ponto é simulado com chave e diodo ideais
+ * para separar o erro do estágio do erro do próprio PWM (quantização do
+ * timer, condução descontínua). Relata tensão efetiva, erro de duty, perdas
+ * e eficiência, e ordena os modos.
+ *
+ *   make model
+ *   make model ARGS="vbat=7.4 rgs=4700 toff=25"
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pwm.h"
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+struct params {
+    double vbat;       /* V */
+    double vdrive;     /* V no coletor do opto */
+    double if_ma;      /* corrente do LED do opto */
+    double ctr;        /* 1.0 = 100 % */
+    double ton_us;     /* atraso do opto na subida do pino */
+    double toff_us;    /* idem na descida (saturação do fototransistor) */
+    double rgs;        /* ohm, gate-source */
+    double qgs_nc;     /* folha de dados, Vds = 44 V */
+    double qgd_nc;
+    double qg_nc;      /* a Vgs = 5 V */
+    double vth;
+    double vpl;        /* platô de Miller */
+    double rds_mohm;   /* a Vgs = 5 V */
+    double vf;         /* diodo de roda livre */
+    double r;          /* ohm, motor */
+    double l_uh;
+    double i0;         /* A, corrente em vazio */
+    double g;          /* A/V, carga viscosa: I = i0 + g * E */
+};
+
+static struct params p = {
+    .vbat = 9.0, .vdrive = 9.0, .if_ma = 10.0, .ctr = 1.0,
+    .ton_us = 4.0, .toff_us = 15.0, .rgs = 1000.0,
+    .qgs_nc = 8.6, .qgd_nc = 25.0, .qg_nc = 48.0,
+    .vth = 1.5, .vpl = 3.0, .rds_mohm = 25.0,
+    .vf = 0.5, .r = 3.0, .l_uh = 200.0, .i0 = 0.2, .g = 0.055,
+};
+
+static const struct {
+    const char *name;
+    double *v;
+} args[] = {
+    { "vbat", &p.vbat }, { "vdrive", &p.vdrive }, { "if", &p.if_ma },
+    { "ctr", &p.ctr }, { "ton", &p.ton_us }, { "toff", &p.toff_us },
+    { "rgs", &p.rgs }, { "qgs", &p.qgs_nc }, { "qgd", &p.qgd_nc },
+    { "qg", &p.qg_nc }, { "vth", &p.vth }, { "vpl", &p.vpl },
+    { "rds", &p.rds_mohm }, { "vf", &p.vf }, { "r", &p.r },
+    { "l", &p.l_uh }, { "i0", &p.i0 }, { "g", &p.g },
+};
+
+#define MODE_ENTRY(name, phase, div) { #name, phase, div },
+static const struct {
+    const char *name;
+    int phase;
+    int div;
+} modes[PWM_FREQ_COUNT] = {
+    PWM_MODES(MODE_ENTRY)
+};
+#undef MODE_ENTRY
+
+static const uint8_t duties[] = { 13, 26, 51, 77, 102, 128, 153, 179, 204,
+                                  230, 255 };
+#define DUTY_COUNT (sizeof(duties) / sizeof(duties[0]))
+
+/* Ajuste de Rds(on) aos pontos de 4, 5 e 10 V da folha de dados. */
+#define RDS_VK      2.5
+#define RDS_MIN_PCT 0.88
+/* Vce(sat) do fototransistor: teto do gate. */
+#define OPTO_VCE    0.2
+
+/* Passo: por carga de gate em transição, senão o máximo. */
+#define DQ_STEP     0.02e-9
+#define DT_MIN      2e-9
+#define DT_MAX      0.5e-6
+/* Tolerância de fase ao comparar com as bordas. */
+#define PH_EPS      1e-12
+
+/* Períodos medidos depois do transitório. */
+#define MEAS_PERIODS 4
+
+/*
+ * Pino OC0A em um período, contando o Timer0: fast PWM liga no BOTTOM e
+ * desliga no compare; phase-correct desliga no compare subindo e liga no
+ * compare descendo. Duty 0 desliga a saída (com_bits() em pwm.c).
+ */
+static void pin_counts(int mode, uint8_t ocr, int *period, int *high)
+{
+    int n, tcnt, up, pin = 0;
+
+    *high = 0;
+    if (!modes[mode].phase) {
+        *period = 256;
+        for (tcnt = 0; tcnt < 256; tcnt++) {
+            if (tcnt == 0)
+                pin = 1;
+            *high += pin && ocr;
+            if (tcnt == ocr)
+                pin = 0;
+        }
+        return;
+    }
+    *period = 510;
+    tcnt = 0;
+    up = 1;
+    pin = 1;            /* ligado no compare da descida anterior */
+    for (n = 0; n < 510; n++) {
+        if (tcnt == ocr)
+            pin = !up;
+        *high += pin && ocr;
+        if (up && ++tcnt == 255)
+            up = 0;
+        else if (!up && --tcnt == 0)
+            up = 1;
+    }
+}
+
+struct gate {
+    double qs, qd, ch, cl, qmax;
+};
+
+static void gate_init(struct gate *gt)
+{
+    gt->qs = p.qgs_nc * 1e-9;
+    gt->qd = p.qgd_nc * 1e-9 * p.vbat / 44.0;   /* Crss ~ linear em Vds */
+    gt->cl = gt->qs / p.vpl;
+    gt->ch = (p.qg_nc - p.qgs_nc - p.qgd_nc) * 1e-9 / (5.0 - p.vpl);
+    gt->qmax = gt->qs + gt->qd + gt->ch * (p.vdrive - OPTO_VCE - p.vpl);
+}
+
+static double gate_v(const struct gate *gt, double q)
+{
+    if (q < gt->qs)
+        return q / gt->cl;
+    if (q < gt->qs + gt->qd)
+        return p.vpl;
+    return p.vpl + (q - gt->qs - gt->qd) / gt->ch;
+}
+
+static double rds(double vgs)
+{
+    double r = p.rds_mohm * 1e-3;
+    double v = r * (5.0 - RDS_VK) / (vgs - RDS_VK);
+
+    return v < r * RDS_MIN_PCT ? r * RDS_MIN_PCT : v;
+}
+
+struct result {
+    double f;
+    double pin_duty;
+    double i_avg, i_min, i_max;
+    double v_eff;        /* média da tensão nos terminais do motor */
+    double p_motor, p_batt, p_cond, p_sw, p_diode, p_drive;
+};
+
+/* Um ponto de operação com FCEM 'e'; ideal = chave e diodo perfeitos. */
+static void simulate(int mode, uint8_t ocr, double e, int ideal,
+                     struct result *res)
+{
+    struct gate gt;
+    int counts, high;
+    double tclk = (double)modes[mode].div / F_CPU;
+    double T, th, ton, toff, tau, ph = 0.0, win;
+    double q = 0.0, i = 0.0, l = p.l_uh * 1e-6;
+    long k, n = 0;
+
+    gate_init(&gt);
+    pin_counts(mode, ocr, &counts, &high);
+    T = counts * tclk;
+    th = high * tclk;
+    ton = ideal ? 0.0 : p.ton_us * 1e-6;
+    toff = ideal ? 0.0 : p.toff_us * 1e-6;
+
+    tau = l / p.r;
+    k = (long)ceil(8.0 * tau / T);
+    if (k < 5)
+        k = 5;
+    win = MEAS_PERIODS * T;
+
+    memset(res, 0, sizeof(*res));
+    res->f = 1.0 / T;
+    res->pin_duty = (double)high / counts;
+    res->i_min = 1e9;
+
+    while (n < k + MEAS_PERIODS) {
+        double next, dt, ig = 0.0, v, vm, vds = 0.0;
+        double isw = 0.0, pc = 0.0, ps = 0.0, pd = 0.0, i1, ir, R, iinf;
+        int on;
+
+        /* saída do opto: pulso do pino atrasado, emendado se sobrepuser */
+        if (high == 0) {
+            on = 0;
+            next = T - ph;
+        } else if (high == counts || th + toff >= T + ton) {
+            on = 1;
+            next = T - ph;
+        } else if (ph < ton - PH_EPS) {
+            on = th + toff > T && ph < th + toff - T - PH_EPS;
+            next = (on ? th + toff - T : ton) - ph;
+        } else if (ph < th + toff - PH_EPS) {
+            on = 1;
+            next = th + toff - ph;
+        } else {
+            on = 0;
+            next = T - ph + ton;
+        }
+        if (next > T - ph)
+            next = T - ph;
+
+        v = gate_v(&gt, q);
+        if (!ideal) {
+            ig = on ? p.ctr * p.if_ma * 1e-3 - v / p.rgs : -v / p.rgs;
+            if (on && q >= gt.qmax)
+                ig = 0.0;
+        }
+        dt = DT_MAX;
+        if (fabs(ig) > 1e-9 && DQ_STEP / fabs(ig) < dt)
+            dt = DQ_STEP / fabs(ig) < DT_MIN ? DT_MIN : DQ_STEP / fabs(ig);
+        if (dt > next)
+            dt = next;
+
+        /* dreno e motor no começo do passo */
+        if (ideal ? on : q >= gt.qs + gt.qd) {
+            R = ideal ? 0.0 : rds(v);
+            iinf = (p.vbat - e) / (p.r + R);
+            i1 = iinf + (i - iinf) * exp(-dt * (p.r + R) / l);
+            if (i1 < 0.0)
+                i1 = 0.0;
+            ir = 0.5 * (i + i1);
+            vm = p.vbat - ir * R;
+            isw = ir;
+            pc = ir * ir * R;
+        } else if (!ideal && q >= gt.qs) {
+            double frac = (q - gt.qs) / gt.qd;
+            double vhi = i > 0.0 ? p.vbat + p.vf : p.vbat - e;
+
+            vds = vhi + (i * rds(p.vpl) - vhi) * frac;
+            vm = p.vbat - vds;
+            iinf = (vm - e) / p.r;
+            i1 = iinf + (i - iinf) * exp(-dt * p.r / l);
+            if (i1 < 0.0)
+                i1 = 0.0;
+            ir = 0.5 * (i + i1);
+            isw = ir;
+            ps = vds * ir;
+        } else if (i > 0.0) {
+            double vf = ideal ? 0.0 : p.vf;
+
+            vm = -vf;
+            iinf = (-vf - e) / p.r;
+            i1 = iinf + (i - iinf) * exp(-dt * p.r / l);
+            if (i1 < 0.0)
+                i1 = 0.0;
+            ir = 0.5 * (i + i1);
+            if (!ideal && v > p.vth) {
+                isw = ir * (v - p.vth) / (p.vpl - p.vth);
+                ps = (p.vbat + vf) * isw;
+            }
+            pd = vf * (ir - isw);
+        } else {
+            vm = e;             /* motor solto, corrente zero */
+            i1 = ir = 0.0;
+        }
+
+        if (n >= k) {
+            res->i_avg += ir * dt;
+            res->v_eff += vm * dt;
+            res->p_motor += vm * ir * dt;
+            res->p_batt += p.vbat * isw * dt;
+            res->p_cond += pc * dt;
+            res->p_sw += ps * dt;
+            res->p_diode += pd * dt;
+            if (on && !ideal)
+                res->p_drive += p.vdrive * p.ctr * p.if_ma * 1e-3 * dt;
+            if (i1 < res->i_min)
+                res->i_min = i1;
+            if (i1 > res->i_max)
+                res->i_max = i1;
+        }
+
+        i = i1;
+        q += ig * dt;
+        if (q < 0.0)
+            q = 0.0;
+        if (q > gt.qmax)
+            q = gt.qmax;
+        ph += dt;
+        if (ph >= T - PH_EPS) {
+            ph = 0.0;
+            n++;
+        }
+    }
+
+    res->i_avg /= win;
+    res->v_eff /= win;
+    res->p_motor /= win;
+    res->p_batt /= win;
+    res->p_cond /= win;
+    res->p_sw /= win;
+    res->p_diode /= win;
+    res->p_drive /= win;
+}
+
+/* Regime: a corrente média do PWM tem de sustentar a carga em E. */
+static void operate(int mode, uint8_t ocr, int ideal, struct result *res)
+{
+    double lo = 0.0, hi = p.vbat, e;
+    int n;
+
+    simulate(mode, ocr, 0.0, ideal, res);
+    if (res->i_avg <= p.i0)
+        return;                 /* não vence o atrito: parado */
+    for (n = 0; n < 16; n++) {
+        e = 0.5 * (lo + hi);
+        simulate(mode, ocr, e, ideal, res);
+        if (res->i_avg > p.i0 + p.g * e)
+            lo = e;
+        else
+            hi = e;
+    }
+    simulate(mode, ocr, lo, ideal, res);
+}
+
+struct summary {
+    int mode;
+    double eta;         /* média dos duties >= 20 % */
+    double err_max;     /* maior |erro do estágio| */
+    double ripple;      /* Ipp a 50 % */
+};
+
+static int by_rank(const void *a, const void *b)
+{
+    const struct summary *x = a, *y = b;
+    int okx = x->err_max <= 0.05, oky = y->err_max <= 0.05;
+
+    if (okx != oky)
+        return oky - okx;
+    if (!okx)
+        return (x->err_max > y->err_max) - (x->err_max < y->err_max);
+    return (x->eta < y->eta) - (x->eta > y->eta);
+}
+
+static void usage(void)
+{
+    size_t n;
+
+    fprintf(stderr, "uso: pwm_model [nome=valor ...]\nparâmetros:");
+    for (n = 0; n < sizeof(args) / sizeof(args[0]); n++)
+        fprintf(stderr, " %s=%g", args[n].name, *args[n].v);
+    fprintf(stderr, "\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    struct summary sum[PWM_FREQ_COUNT];
+    struct result r, ri;
+    int a, m;
+    size_t n, d;
+
+    for (a = 1; a < argc; a++) {
+        const char *eq = strchr(argv[a], '=');
+
+        for (n = 0; eq && n < sizeof(args) / sizeof(args[0]); n++) {
+            if (strlen(args[n].name) == (size_t)(eq - argv[a]) &&
+                strncmp(argv[a], args[n].name, eq - argv[a]) == 0) {
+                *args[n].v = atof(eq + 1);
+                break;
+            }
+        }
+        if (!eq || n == sizeof(args) / sizeof(args[0]))
+            usage();
+    }
+
+    printf("Vbat %.1f V, opto %.0f%% x %.0f mA, atraso %.0f/%.0f us, "
+           "RGS %.0f, motor %.1f ohm %.0f uH\n\n",
+           p.vbat, p.ctr * 100, p.if_ma, p.ton_us, p.toff_us, p.rgs, p.r,
+           p.l_uh);
+    printf("%-6s %8s %5s %6s %6s %7s %7s %6s %6s %6s %6s %6s %6s %5s\n",
+           "modo", "f(Hz)", "duty", "pino", "Veff", "erro%", "estag%",
+           "Iavg", "Ipp", "Pcond", "Psw", "Pdiod", "Pacio", "ef%");
+
+    for (m = 0; m < PWM_FREQ_COUNT; m++) {
+        double eta_sum = 0.0;
+        int eta_n = 0;
+
+        sum[m].mode = m;
+        sum[m].err_max = 0.0;
+        sum[m].ripple = 0.0;
+        for (d = 0; d < DUTY_COUNT; d++) {
+            double cmd = duties[d] / 255.0, deff, dideal, eta, bal;
+
+            operate(m, duties[d], 0, &r);
+            operate(m, duties[d], 1, &ri);
+            deff = r.v_eff / p.vbat;
+            dideal = ri.v_eff / p.vbat;
+            eta = r.p_batt > 0.0 ? r.p_motor / (r.p_batt + r.p_drive) : 0.0;
+
+            /* conservação: bateria = motor + chave + diodo */
+            bal = r.p_batt - r.p_motor - r.p_cond - r.p_sw - r.p_diode;
+            if (fabs(bal) > 0.01 * r.p_batt + 1e-4) {
+                fprintf(stderr, "balanço de energia falhou: %s duty %d "
+                        "(%.4f W)\n", modes[m].name, duties[d], bal);
+                return 1;
+            }
+
+            printf("%-6s %8.0f %4.0f%% %5.1f%% %6.2f %+7.1f %+7.1f %6.3f "
+                   "%6.3f %6.3f %6.3f %6.3f %6.3f %5.1f\n",
+                   modes[m].name, r.f, cmd * 100, r.pin_duty * 100, r.v_eff,
+                   (deff - cmd) * 100, (deff - dideal) * 100, r.i_avg,
+                   r.i_max - r.i_min, r.p_cond, r.p_sw, r.p_diode,
+                   r.p_drive, eta * 100);
+
+            if (fabs(deff - dideal) > sum[m].err_max)
+                sum[m].err_max = fabs(deff - dideal);
+            if (duties[d] == 128)
+                sum[m].ripple = r.i_max - r.i_min;
+            if (cmd >= 0.2) {
+                eta_sum += eta;
+                eta_n++;
+            }
+        }
+        sum[m].eta = eta_sum / eta_n;
+        printf("\n");
+    }
+
+    qsort(sum, PWM_FREQ_COUNT, sizeof(sum[0]), by_rank);
+    printf("Ordem (erro do estágio <= 5%%, por eficiência; depois os "
+           "descartados, por erro):\n");
+    for (m = 0; m < PWM_FREQ_COUNT; m++) {
+        const int k = sum[m].mode;
+        const double f = F_CPU / ((double)modes[k].div *
+                                  (modes[k].phase ? 510 : 256));
+
+        printf("  %d. PWM_FREQ_%-5s ef %5.1f%%  erro máx %4.1f%%  "
+               "Ipp@50%% %.3f A%s%s\n", m + 1, modes[k].name,
+               sum[m].eta * 100, sum[m].err_max * 100, sum[m].ripple,
+               f < 20000 ? "  audível" : "",
+               sum[m].err_max > 0.05 ? "  (descartado)" : "");
+    }
+    return 0;
+}
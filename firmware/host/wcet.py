@@ -0,0 +1,664 @@
+#!/usr/bin/env python3
+"""
+Análise estática de WCET do firmware (ATmega328P, AVRe+).
+
+Lê o ELF com avr-objdump (-t para as funções, -d -l para as instruções e as
+linhas de fonte), monta o grafo de fluxo de cada função e calcula o pior
+caso em ciclos:
+
+  - todo laço precisa de limite: comentário /* wcet-loop: N */ na linha do
+    laço (N pode usar #defines numéricos do firmware), laço contado
+    reconhecido aqui (ldi + dec/subi/sbci/sbiw + brne, como em _delay_us e
+    na libgcc, inclusive com entrada no meio do laço) ou entrada em
+    host/wcet_bounds para funções sem fonte;
+  - chamadas somam o pior caso do chamado; recursão e icall são erro;
+  - salto indireto (switch por tabela) pode cair em qualquer instrução
+    seguinte da função.
+
+Depois confere os prazos:
+
+  ISRs        resposta = ciclos próprios + bloqueio (maior outra ISR ou
+              trecho com cli) + interferência das ISRs de maior prioridade
+  quadro      as tarefas que caem no mesmo tick + radio_poll + as ISRs do
+              período cabem em um tick; cobre também o ACK recarregado a
+              cada comando e o failsafe, que só dependem disso
+  pareamento  o quadro com pairing_poll() termina antes de o contador de
+              8 bits de sched_ticks() dar a volta
+
+Sai com 1 se algum prazo pode ser perdido ou se a análise não fecha.
+
+    make wcet
+    host/wcet.py build/carrinho.elf [--objdump avr-objdump] [--f-cpu N]
+                 [--json]
+"""
+import argparse
+import bisect
+import glob
+import json
+import math
+import os
+import re
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+FIRMWARE = os.path.dirname(HERE)
+
+# Ciclos no caminho que não desvia (folha de dados do ATmega328P).
+CYCLES = {}
+for m in ('add adc sub subi sbc sbci and andi or ori eor com neg sbr cbr '
+          'inc dec tst clr ser mov movw ldi in out nop sleep wdr break '
+          'bset bclr sec clc sen cln sez clz sei cli ses cls sev clv set '
+          'clt seh clh bst bld lsl lsr rol ror asr swap cp cpc cpi').split():
+    CYCLES[m] = 1
+for m in ('adiw sbiw mul muls mulsu fmul fmuls fmulsu sbi cbi ld ldd lds '
+          'st std sts push pop rjmp ijmp').split():
+    CYCLES[m] = 2
+for m in 'jmp rcall icall lpm elpm'.split():
+    CYCLES[m] = 3
+for m in 'call ret reti'.split():
+    CYCLES[m] = 4
+
+BRANCHES = set(('brbs brbc breq brne brcs brcc brsh brlo brmi brpl brge '
+                'brlt brhs brhc brts brtc brvs brvc brie brid').split())
+SKIPS = set('cpse sbrc sbrs sbic sbis'.split())
+# Instruções cujo primeiro operando não é escrito.
+NO_DEST = set('st std sts out push cp cpc cpi cpse sbrc sbrs tst'.split())
+TABLEJUMPS = ('__tablejump__', '__tablejump2__')
+TABLEJUMP_CYCLES = 11      # lsl, rol, 2 x lpm, mov, ijmp
+
+# Entrada na ISR: 4 ciclos de resposta + jmp no vetor.
+ISR_ENTRY = 7
+
+VECTORS = [None, 'INT0', 'INT1', 'PCINT0', 'PCINT1', 'PCINT2', 'WDT',
+           'TIMER2_COMPA', 'TIMER2_COMPB', 'TIMER2_OVF', 'TIMER1_CAPT',
+           'TIMER1_COMPA', 'TIMER1_COMPB', 'TIMER1_OVF', 'TIMER0_COMPA',
+           'TIMER0_COMPB', 'TIMER0_OVF', 'SPI_STC', 'USART_RX',
+           'USART_UDRE', 'USART_TX', 'ADC', 'EE_READY', 'ANALOG_COMP',
+           'TWI', 'SPM_READY']
+
+TASKS = ['radio_poll', 'task_200hz', 'task_100hz', 'task_10hz', 'task_1hz']
+PAIRING = 'pairing_poll'
+
+ANNOT_RE = re.compile(r'/\*\s*wcet-loop:\s*([^*]+?)\s*\*/')
+SRC_RE = re.compile(r'^(\S+\.[chS]):(\d+)(?: \(discriminator \d+\))?$')
+INSN_RE = re.compile(r'^\s*([0-9a-f]+):\t((?:[0-9a-f]{2} )+)\s*\t(\S+)'
+                     r'\s*([^;]*?)\s*(?:;\s*(.*))?$')
+SYM_RE = re.compile(r'^([0-9a-f]+) (.{7}) (\S+)\s+([0-9a-f]+) (.+)$')
+
+
+class AnalysisError(Exception):
+    pass
+
+
+class Insn:
+    __slots__ = ('addr', 'size', 'mnem', 'ops', 'target', 'src')
+
+    def __init__(self, addr, size, mnem, ops, target, src):
+        self.addr = addr
+        self.size = size
+        self.mnem = mnem
+        self.ops = ops
+        self.target = target
+        self.src = src
+
+    def __repr__(self):
+        return '%x: %s %s' % (self.addr, self.mnem, ', '.join(self.ops))
+
+
+def defines():
+    """#defines numéricos do firmware, para os limites simbólicos."""
+    out = {}
+    pat = re.compile(r'^\s*#\s*define\s+(\w+)\s+\(?\s*(\d+)[UuLl]*\s*\)?\s*'
+                     r'(?:/\*.*)?$')
+    for path in sorted(glob.glob(os.path.join(FIRMWARE, '*.[ch]'))):
+        with open(path, encoding='utf-8') as f:
+            for line in f:
+                m = pat.match(line)
+                if m and m.group(1) not in out:
+                    out[m.group(1)] = int(m.group(2))
+    return out
+
+
+def eval_bound(text, defs, where):
+    expr = re.sub(r'[A-Za-z_]\w*',
+                  lambda m: str(defs[m.group(0)]) if m.group(0) in defs
+                  else '!' + m.group(0), text)
+    if not re.fullmatch(r'[\d\s+\-*/()]+', expr):
+        raise AnalysisError('%s: limite "%s" não é numérico' % (where, text))
+    return int(eval(expr.replace('/', '//')))
+
+
+class Image:
+    def __init__(self, symtab, disasm, bounds):
+        self.funcs = {}        # nome -> (início, fim)
+        self.by_addr = {}      # início -> nome
+        self.insns = {}        # endereço -> Insn
+        self.bounds = bounds
+        self.defs = defines()
+        self.annots = {}
+        self.claimed = set()
+        self.memo = {}
+        self.stack = []
+        self._parse_symtab(symtab)
+        self._parse_disasm(disasm)
+        self.order = sorted(self.insns)
+
+    def _parse_symtab(self, text):
+        for line in text.splitlines():
+            m = SYM_RE.match(line)
+            if not m or 'F' not in m.group(2) or m.group(3) != '.text':
+                continue
+            start, size = int(m.group(1), 16), int(m.group(4), 16)
+            name = m.group(5).strip()
+            if size == 0:
+                continue
+            self.funcs[name] = (start, start + size)
+            self.by_addr[start] = name
+
+    def _parse_disasm(self, text):
+        src = None
+        for line in text.splitlines():
+            if re.match(r'^[0-9a-f]+ <.+>:$', line):
+                src = None
+                continue
+            m = SRC_RE.match(line.strip())
+            if m:
+                src = (os.path.normpath(m.group(1)), int(m.group(2)))
+                continue
+            m = INSN_RE.match(line)
+            if not m:
+                continue
+            addr = int(m.group(1), 16)
+            size = len(m.group(2).split())
+            mnem = m.group(3)
+            ops = [o.strip() for o in m.group(4).split(',') if o.strip()]
+            target = None
+            if m.group(5):
+                t = re.match(r'0x([0-9a-f]+)', m.group(5))
+                if t:
+                    target = int(t.group(1), 16)
+            if target is None and mnem in ('jmp', 'call') and ops:
+                target = int(ops[0], 16)
+            self.insns[addr] = Insn(addr, size, mnem, ops, target, src)
+
+    # --- fonte ---------------------------------------------------------
+
+    def annotation(self, src):
+        path, line = src
+        if path not in self.annots:
+            table = {}
+            full = path if os.path.isabs(path) else \
+                os.path.join(FIRMWARE, path)
+            try:
+                with open(full, encoding='utf-8') as f:
+                    for n, text in enumerate(f, 1):
+                        m = ANNOT_RE.search(text)
+                        if m:
+                            table[n] = eval_bound(
+                                m.group(1), self.defs, '%s:%d' % (path, n))
+            except OSError:
+                pass
+            self.annots[path] = table
+        return self.annots[path].get(line)
+
+    # --- grafo ---------------------------------------------------------
+
+    def func_at(self, addr):
+        return self.by_addr.get(addr)
+
+    def insn(self, addr, fname):
+        i = self.insns.get(addr)
+        if i is None:
+            raise AnalysisError('%s: sem instrução em 0x%x' % (fname, addr))
+        return i
+
+    def edges(self, fname, i):
+        """(custo, chamado, [(destino, ciclos extras)]) de uma instrução."""
+        start, end = self.funcs[fname]
+        nxt = i.addr + i.size
+        m = i.mnem
+        if m not in CYCLES and m not in BRANCHES and m not in SKIPS:
+            raise AnalysisError('%s: instrução sem custo conhecido: %r'
+                                % (fname, i))
+        cost = CYCLES.get(m, 1)
+
+        def fall():
+            if nxt < end:
+                return None, [(nxt, 0)]
+            if self.func_at(nxt):          # cai na função seguinte
+                return self.func_at(nxt), []
+            raise AnalysisError('%s: sai do fim da função em %r' % (fname, i))
+
+        def later():
+            lo = bisect.bisect_right(self.order, i.addr)
+            hi = bisect.bisect_left(self.order, end)
+            return [(a, 0) for a in self.order[lo:hi]]
+
+        if m in ('ret', 'reti'):
+            return cost, None, []
+        if m in BRANCHES:
+            if not start <= i.target < end:
+                raise AnalysisError('%s: desvio para fora: %r' % (fname, i))
+            return cost, None, [(nxt, 0), (i.target, 1)]
+        if m in SKIPS:
+            skipped = self.insn(nxt, fname)
+            return cost, None, [(nxt, 0), (nxt + skipped.size,
+                                           skipped.size // 2)]
+        if m == 'ijmp':
+            return cost, None, later()
+        if m in ('rjmp', 'jmp'):
+            callee = self.func_at(i.target)
+            if callee in TABLEJUMPS:
+                return cost, callee, later()
+            if start <= i.target < end:
+                return cost, None, [(i.target, 0)]
+            if callee:                      # chamada de cauda
+                return cost, callee, []
+            raise AnalysisError('%s: salto para fora: %r' % (fname, i))
+        if m in ('call', 'rcall'):
+            callee = self.func_at(i.target)
+            if not callee:
+                raise AnalysisError('%s: chamada sem símbolo: %r'
+                                    % (fname, i))
+            callee2, succ = fall()
+            if callee2:
+                raise AnalysisError('%s: chamada no fim da função' % fname)
+            return cost, callee, succ
+        if m == 'icall':
+            raise AnalysisError('%s: chamada indireta não suportada: %r'
+                                % (fname, i))
+        callee, succ = fall()
+        return cost, callee, succ
+
+    def wcet(self, fname, exclude=frozenset()):
+        key = (fname, exclude)
+        if key in self.memo:
+            return self.memo[key]
+        if fname in self.stack:
+            raise AnalysisError('recursão: %s' % ' -> '.join(
+                self.stack + [fname]))
+        if fname not in self.funcs:
+            raise AnalysisError('função não encontrada: %s' % fname)
+        self.stack.append(fname)
+        try:
+            value = self._wcet(fname, exclude)
+        finally:
+            self.stack.pop()
+        self.memo[key] = value
+        return value
+
+    def _wcet(self, fname, exclude):
+        start, _ = self.funcs[fname]
+        node = {}              # endereço -> (custo, chamado, sucessores)
+        order = []             # pós-ordem
+        back = set()           # (origem, destino)
+        state = {}
+        stack = [(start, 0)]
+        state[start] = 1
+        while stack:
+            a, k = stack.pop()
+            if a not in node:
+                node[a] = self.edges(fname, self.insn(a, fname))
+            succ = node[a][2]
+            if k < len(succ):
+                stack.append((a, k + 1))
+                b = succ[k][0]
+                if state.get(b) == 1:
+                    back.add((a, b))
+                elif b not in state:
+                    state[b] = 1
+                    stack.append((b, 0))
+            else:
+                state[a] = 2
+                order.append(a)
+
+        weight = {}
+        for a, (cost, callee, _) in node.items():
+            if callee in TABLEJUMPS:
+                cost += TABLEJUMP_CYCLES
+            elif callee and callee not in exclude:
+                cost += self.wcet(callee, exclude)
+            weight[a] = cost
+
+        # laços naturais, do mais interno para fora
+        loops = {}
+        for u, h in back:
+            loops.setdefault(h, set()).add(u)
+        preds = {}
+        for a, (_, _, succ) in node.items():
+            for b, _ in succ:
+                if (a, b) not in back:
+                    preds.setdefault(b, []).append(a)
+        bodies = []
+        for h, sources in loops.items():
+            body = {h}
+            work = list(sources)
+            while work:
+                x = work.pop()
+                if x in body:
+                    continue
+                body.add(x)
+                work.extend(preds.get(x, []))
+            bodies.append((len(body), h, sources, body))
+        bodies.sort()
+
+        topo = list(reversed(order))
+        for _, h, sources, body in bodies:
+            entries = [a for a in preds.get(h, []) if a not in body]
+            bound = self.loop_bound(fname, h, sources, body, entries)
+            dist = {h: weight[h]}
+            for a in topo:
+                if a not in dist:
+                    continue
+                for b, extra in node[a][2]:
+                    if b in body and (a, b) not in back:
+                        d = dist[a] + extra + weight[b]
+                        if d > dist.get(b, -1):
+                            dist[b] = d
+            it = 0
+            for u in sources:
+                extra = max(e for b, e in node[u][2] if b == h)
+                it = max(it, dist.get(u, 0) + extra)
+            weight[h] += bound * it
+
+        dist = {start: weight[start]}
+        best = 0
+        for a in topo:
+            if a not in dist:
+                continue
+            succ = [(b, e) for b, e in node[a][2] if (a, b) not in back]
+            if not node[a][2]:
+                best = max(best, dist[a])
+            for b, extra in succ:
+                d = dist[a] + extra + weight[b]
+                if d > dist.get(b, -1):
+                    dist[b] = d
+        return best
+
+    # --- limites -------------------------------------------------------
+
+    def loop_bound(self, fname, h, sources, body, entries):
+        head = self.insns[h]
+        lines = {}
+        for a in body:
+            src = self.insns[a].src
+            if src and src not in self.claimed:
+                n = self.annotation(src)
+                if n is not None:
+                    lines[src] = n
+        if lines:
+            prefer = [self.insns[a].src for a in [h] + sorted(sources)]
+            pick = [s for s in prefer if s in lines]
+            if pick:
+                self.claimed.add(pick[0])
+                return lines[pick[0]]
+            self.claimed.update(lines)
+            return max(lines.values())
+        n = self.counted(body, entries)
+        if n is not None:
+            return n
+        if fname in self.bounds:
+            return self.bounds[fname]
+        where = '%s:%d' % head.src if head.src else 'sem fonte'
+        raise AnalysisError('%s: laço em 0x%x (%s) sem limite' %
+                            (fname, h, where))
+
+    def counted(self, body, entries):
+        """
+        Laço contado: contador carregado com ldi antes da entrada e
+        decrementado logo antes do único desvio que fica no laço e sai dele.
+        A entrada pode ser no meio do corpo (rjmp para o teste, como em
+        __udivmodsi4); aí o cabeçalho visto pela DFS não é o topo do laço.
+        """
+        if not entries:
+            return None
+        exits = []
+        for a in body:
+            i = self.insns[a]
+            if (i.mnem in ('brne', 'brcc') and i.target in body and
+                    a + i.size not in body):
+                exits.append(a)
+        if len(exits) != 1:
+            return None
+        u = exits[0]
+        br = self.insns[u]
+        addrs = self.order[:bisect.bisect_left(self.order, u)]
+        regs = []
+        k = len(addrs) - 1
+        while k >= 0 and self.insns[addrs[k]].mnem == 'sbci':
+            i = self.insns[addrs[k]]
+            if i.ops[1] not in ('0x00', '0'):
+                return None
+            regs.insert(0, i.ops[0])
+            k -= 1
+        if k < 0:
+            return None
+        i = self.insns[addrs[k]]
+        if i.mnem == 'dec' or (i.mnem == 'subi' and i.ops[1] in ('0x01',
+                                                                  '1')):
+            regs.insert(0, i.ops[0])
+        elif i.mnem == 'sbiw' and i.ops[1] in ('0x01', '1'):
+            n = int(i.ops[0][1:])
+            regs[0:0] = ['r%d' % n, 'r%d' % (n + 1)]
+        else:
+            return None
+        worst = 0
+        for e in entries:
+            value = 0
+            for pos, reg in enumerate(regs):
+                v = self.init_value(reg, e)
+                if v is None:
+                    return None
+                value |= v << (8 * pos)
+            if br.mnem == 'brcc':
+                value += 1
+            worst = max(worst, value or (1 << (8 * len(regs))))
+        return worst
+
+    def init_value(self, reg, entry):
+        """Valor de 'reg' ao sair de 'entry' rumo ao laço (busca para trás)."""
+        lo = bisect.bisect_right(self.order, entry)
+        for a in reversed(self.order[max(0, lo - 16):lo]):
+            i = self.insns[a]
+            if i.mnem in ('call', 'rcall', 'ret', 'reti', 'icall'):
+                return None
+            if not i.ops or i.mnem in NO_DEST:
+                continue
+            dest = [i.ops[0]]
+            if i.mnem in ('movw', 'adiw', 'sbiw'):
+                dest.append('r%d' % (int(i.ops[0][1:]) + 1))
+            if reg not in dest:
+                continue
+            if i.mnem == 'ldi':
+                return int(i.ops[1], 0) & 0xFF
+            if i.mnem in ('clr', 'eor', 'sub') and i.ops[0] == i.ops[-1]:
+                return 0
+            return None
+        return None
+
+    # --- cli -----------------------------------------------------------
+
+    def cli_sections(self, isrs):
+        """Maior trecho com interrupções desligadas fora das ISRs."""
+        worst, where = 0, None
+        for fname, (start, end) in self.funcs.items():
+            if fname in isrs:
+                continue
+            lo = bisect.bisect_left(self.order, start)
+            hi = bisect.bisect_left(self.order, end)
+            for a in self.order[lo:hi]:
+                if self.insns[a].mnem != 'cli':
+                    continue
+                total, b = 0, a
+                while start <= b < end and b in self.insns:
+                    i = self.insns[b]
+                    total += CYCLES.get(i.mnem, 1)
+                    if i.mnem in BRANCHES or i.mnem in SKIPS:
+                        total += 2
+                    if i.mnem in ('call', 'rcall') and self.func_at(i.target):
+                        total += self.wcet(self.func_at(i.target))
+                    if (i.mnem == 'sei' or i.mnem in ('ret', 'reti') or
+                            (i.mnem == 'out' and i.ops[0] == '0x3f')):
+                        break
+                    b += i.size
+                if total > worst:
+                    worst, where = total, '%s+0x%x' % (fname, a - start)
+        return worst, where
+
+
+def read_bounds(path):
+    out = {}
+    if not os.path.exists(path):
+        return out
+    with open(path, encoding='utf-8') as f:
+        for n, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            parts = line.split()
+            if len(parts) != 2:
+                raise AnalysisError('%s:%d: esperado "função limite"'
+                                    % (path, n))
+            out[parts[0]] = int(parts[1], 0)
+    return out
+
+
+def run(cmd):
+    try:
+        return subprocess.run(cmd, check=True, stdout=subprocess.PIPE,
+                              universal_newlines=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        raise AnalysisError('%s: %s' % (cmd[0], e))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+    ap.add_argument('elf', nargs='?')
+    ap.add_argument('--objdump', default='avr-objdump')
+    ap.add_argument('--symtab', help='saída de objdump -t já gerada')
+    ap.add_argument('--disasm', help='saída de objdump -d -l já gerada')
+    ap.add_argument('--bounds', default=os.path.join(HERE, 'wcet_bounds'))
+    ap.add_argument('--f-cpu', type=int, default=None)
+    ap.add_argument('--enc-hz', type=float, default=2000.0,
+                    help='bordas de encoder por segundo (PCINT2)')
+    ap.add_argument('-v', '--verbose', action='store_true')
+    ap.add_argument('--json', action='store_true',
+                    help='resultado em JSON (host/bench.py)')
+    args = ap.parse_args()
+
+    try:
+        if args.symtab and args.disasm:
+            with open(args.symtab) as f:
+                symtab = f.read()
+            with open(args.disasm) as f:
+                disasm = f.read()
+        elif args.elf:
+            symtab = run([args.objdump, '-t', args.elf])
+            disasm = run([args.objdump, '-d', '-l', args.elf])
+        else:
+            ap.error('informe o ELF ou --symtab e --disasm')
+        img = Image(symtab, disasm, read_bounds(args.bounds))
+        return check(img, args)
+    except AnalysisError as e:
+        print('wcet: %s' % e, file=sys.stderr)
+        return 1
+
+
+def check(img, args):
+    d = img.defs
+    f_cpu = args.f_cpu or d.get('F_CPU', 16000000)
+    tick = f_cpu // d['SCHED_HZ']
+    byte = 9 * f_cpu // d['TWI_FREQ']
+    us = 1e6 / f_cpu
+    rows = []
+    failed = False
+
+    def row(what, cycles, deadline, note=''):
+        nonlocal failed
+        ok = cycles <= deadline
+        failed |= not ok
+        rows.append((what, cycles, deadline, ok, note))
+
+    # ISRs: período mínimo, prazo e chegadas num quadro de um tick
+    isrs = {}
+    for name in img.funcs:
+        m = re.fullmatch(r'__vector_(\d+)', name)
+        if not m:
+            continue
+        vec = int(m.group(1))
+        label = VECTORS[vec] if vec < len(VECTORS) else name
+        if label == 'TIMER1_COMPA':
+            period, dl, n = tick, tick, 2
+            note = 'tick + laser'
+        elif label == 'TIMER0_OVF':
+            period, dl, n = 256, 512, 1
+            note = 'troca de PWM: no máximo 1 período a mais a 62,5 kHz'
+        elif label == 'TWI':
+            period, dl, n = byte, byte, 16
+            note = 'um byte a %d Hz' % d['TWI_FREQ']
+        elif label == 'PCINT2':
+            period = int(f_cpu / args.enc_hz)
+            dl, n = period, math.ceil(tick / period) + 1
+            note = 'bordas dos encoders'
+        else:
+            period, dl, n = tick, tick, 2
+            note = ''
+        isrs[name] = dict(vec=vec, label=label, period=period, deadline=dl,
+                          frame=n, note=note,
+                          cost=img.wcet(name) + ISR_ENTRY)
+
+    cli, cli_at = img.cli_sections(isrs)
+    for name, i in sorted(isrs.items(), key=lambda x: x[1]['vec']):
+        block = max([cli] + [j['cost'] for k, j in isrs.items()
+                             if k != name])
+        higher = [j for j in isrs.values() if j['vec'] < i['vec']]
+        r = i['cost'] + block
+        for _ in range(100):
+            nr = i['cost'] + block + sum(
+                math.ceil(r / j['period']) * j['cost'] for j in higher)
+            if nr == r or nr > i['deadline']:
+                r = nr
+                break
+            r = nr
+        row('ISR %s' % i['label'], r, i['deadline'],
+            '%s; própria %d' % (i['note'], i['cost']))
+
+    isr_frame = sum(i['frame'] * i['cost'] for i in isrs.values())
+    tasks = {t: img.wcet(t, frozenset([PAIRING])) for t in TASKS}
+    frame = sum(tasks.values()) + isr_frame
+    row('quadro de jogo', frame, tick,
+        'tarefas %d + ISRs %d' % (sum(tasks.values()), isr_frame))
+
+    pairing = (frame - tasks['task_100hz'] + img.wcet('task_100hz'))
+    row('quadro de pareamento', pairing, 255 * tick,
+        'antes de sched_ticks() dar a volta')
+
+    if args.json:
+        print(json.dumps({
+            'f_cpu': f_cpu,
+            'linhas': [dict(item=w, ciclos=c, prazo=dl, ok=ok)
+                       for w, c, dl, ok, _ in rows],
+            'cli': cli,
+        }, indent=1))
+        return 1 if failed else 0
+
+    print('%-26s %10s %10s %10s  %s' % ('', 'ciclos', 'µs', 'prazo µs',
+                                        ''))
+    for what, cycles, deadline, ok, note in rows:
+        print('%-26s %10d %10.1f %10.1f  %s  %s' % (
+            what, cycles, cycles * us, deadline * us,
+            'ok   ' if ok else 'FALHA', note))
+    if cli_at:
+        print('\nmaior trecho com cli: %d ciclos em %s' % (cli, cli_at))
+    if args.verbose:
+        print()
+        for t, c in tasks.items():
+            print('%-26s %10d %10.1f' % (t, c, c * us))
+        print('%-26s %10d %10.1f' % (PAIRING, img.wcet(PAIRING),
+                                     img.wcet(PAIRING) * us))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,90 @@
+#include "config.h"
+#include "laser.h"
+#include "sched.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+#define PERIOD_TICKS ((uint8_t)((uint32_t)LASER_PERIOD_MS * SCHED_HZ / 1000))
+#define PULSE_TICKS  ((uint8_t)((uint32_t)LASER_PULSE_MS * SCHED_HZ / 1000))
+
+#define laser_on()  (LASER_PORT |= _BV(LASER_PIN))
+#define laser_off() (LASER_PORT &= ~_BV(LASER_PIN))
+
+static volatile uint8_t enabled;
+static volatile uint8_t ammo;
+static volatile uint8_t reload;
+/* largura pedida; só passa a valer no início do próximo tiro */
+static volatile uint8_t pulse = PULSE_TICKS;
+
+/* só o ISR mexe nestes */
+static uint8_t phase;
+static uint8_t width;
+
+void laser_init(void)
+{
+    laser_off();
+    LASER_DDR |= _BV(LASER_PIN);
+
+    ammo = LASER_MAGAZINE;
+    reload = 0;
+    enabled = 0;
+    phase = 0;
+    width = 0;
+}
+
+void laser_enable(uint8_t on)
+{
+    enabled = on;
+    if (!on)
+        laser_off();
+}
+
+void laser_set_team(uint8_t team)
+{
+    pulse = (uint8_t)(PULSE_TICKS * ((team & (LASER_TEAMS - 1)) + 1));
+}
+
+void laser_rearm(void)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    ammo = LASER_MAGAZINE;
+    reload = 0;
+    SREG = sreg;
+}
+
+uint8_t laser_ammo(void)        { return ammo; }
+uint8_t laser_reload_left(void) { return reload; }
+
+int16_t laser_ammo_report(void)
+{
+    uint8_t a, r;
+    uint8_t sreg = SREG;
+
+    cli();
+    a = ammo;
+    r = reload;
+    SREG = sreg;
+    return a ? (int16_t)a : -(int16_t)r;
+}
+
+void laser_tick(void)
+{
+    if (phase == 0) {
+        /* caminho do tiro primeiro; a contabilidade vem depois */
+        if (enabled && ammo) {
+            laser_on();
+            width = pulse;
+            if (--ammo == 0)
+                reload = LASER_RELOAD_PERIODS;
+        } else if (reload && --reload == 0) {
+            ammo = LASER_MAGAZINE;
+        }
+    } else if (phase == width) {
+        laser_off();
+    }
+    if (++phase == PERIOD_TICKS)
+        phase = 0;
+}
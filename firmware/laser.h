@@ -0,0 +1,60 @@
+/*
+ * Disparo do laser pelo Timer1, com munição e recarga.
+ *
+ * laser_tick() roda no ISR do tick de 5 ms do Timer1 (sched.c) e conta o
+ * período de disparo (1 s): no início do período o laser acende, se houver
+ * munição, e apaga depois da largura do pulso. Acabando o pente, os
+ * próximos LASER_RELOAD_PERIODS períodos são de recarga. Toda a lógica de
+ * munição é de tempo constante e roda depois de acender o laser.
+ *
+ * Períodos e larguras precisam ser múltiplos do tick (5 ms).
+ *
+ * A equipe vai na largura do pulso: (equipe + 1) · LASER_PULSE_MS. O LDR é
+ * lento demais para modulação mais fina; larguras de 40 ms em 40 ms ele
+ * separa com folga.
+ */
+#ifndef LASER_H
+#define LASER_H
+
+#include <stdint.h>
+
+#ifndef LASER_PERIOD_MS
+#define LASER_PERIOD_MS        1000
+#endif
+/* Largura do pulso da equipe 0; as outras são múltiplos. */
+#ifndef LASER_PULSE_MS
+#define LASER_PULSE_MS         40
+#endif
+#define LASER_TEAMS            4
+#ifndef LASER_MAGAZINE
+#define LASER_MAGAZINE         10
+#endif
+/* Períodos de disparo sem tiro enquanto recarrega. */
+#ifndef LASER_RELOAD_PERIODS
+#define LASER_RELOAD_PERIODS   3
+#endif
+
+void laser_init(void);
+
+/* Só para o ISR do tick. */
+void laser_tick(void);
+
+/* Liga/desliga os disparos (ex.: desligado quando o carrinho está fora). */
+void laser_enable(uint8_t on);
+
+/* Equipe 0..3: define a largura do pulso a partir do próximo disparo. */
+void laser_set_team(uint8_t team);
+
+/* Enche o pente e cancela a recarga (início de partida). */
+void laser_rearm(void);
+
+uint8_t laser_ammo(void);
+uint8_t laser_reload_left(void);   /* períodos até o pente voltar */
+
+/*
+ * Valor para a telemetria: munição restante, ou -períodos de recarga
+ * quando o pente está vazio. O transmissor mostra direto no display.
+ */
+int16_t laser_ammo_report(void);
+
+#endif /* LASER_H */
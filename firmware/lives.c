@@ -0,0 +1,50 @@
+#include "config.h"
+#include "buzzer.h"
+#include "laser.h"
+#include "lives.h"
+#include "pwm.h"
+#include "state.h"
+
+#include <avr/io.h>
+
+static void show(uint8_t n)
+{
+    /* n LEDs acesos a partir do primeiro */
+    LIFE_PORT = (LIFE_PORT & ~LIFE_MASK) |
+                ((uint8_t)(((1 << n) - 1) << LIFE_SHIFT) & LIFE_MASK);
+}
+
+void lives_init(void)
+{
+    LIFE_DDR |= LIFE_MASK;
+    lives_reset();
+}
+
+void lives_reset(void)
+{
+    CAR_SET_LIVES(LIVES_MAX);
+    CAR_SET_OUT(0);
+    show(LIVES_MAX);
+    laser_enable(1);
+}
+
+uint8_t lives_hit(void)
+{
+    uint8_t n = CAR_LIVES();
+
+    if (n == 0)
+        return 0;
+    CAR_SET_LIVES(--n);
+    show(n);
+    if (n == 0) {
+        CAR_SET_OUT(1);
+        pwm_set(0, 0);
+        laser_enable(0);
+        buzzer_play(MELODY_OUT);
+    } else if (n == 1) {
+        buzzer_play(MELODY_LAST_LIFE);
+    } else {
+        buzzer_play(MELODY_HIT);
+    }
+    return n;
+}
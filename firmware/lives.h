@@ -0,0 +1,20 @@
+/*
+ * Vidas do carrinho e LEDs de vida.
+ *
+ * Cada acerto apaga um LED; com 0 o carrinho fica fora: motores parados e
+ * laser desligado até lives_reset() (CMD_MATCH, início de partida).
+ */
+#ifndef LIVES_H
+#define LIVES_H
+
+#include <stdint.h>
+
+#define LIVES_MAX 3
+
+void lives_init(void);
+void lives_reset(void);
+
+/* Aplica um acerto; retorna as vidas restantes. */
+uint8_t lives_hit(void);
+
+#endif /* LIVES_H */
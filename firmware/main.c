@@ -0,0 +1,275 @@
+/*
+ * Firmware do carrinho: inicialização e laço principal.
+ *
+ * O Timer1 gera o tick de 5 ms (sched.c). O laço consome os ticks e roda
+ * as tarefas fora de interrupção:
+ *
+ *   200 Hz  detecção de acertos (LDR), só com vínculo
+ *   100 Hz  buzzer, pareamento ou rumo + mixer dos motores e odometria
+ *    10 Hz  modelo térmico (derating aplicado em pwm_set())
+ *   sempre  pacotes do rádio (comandos, consultas e payload do ACK)
+ *
+ * Sem comando por MAIN_FAILSAFE_TICKS os motores param. No boot, antes de
+ * entrar no link, a varredura de canais (chanscan.c) roda uma vez e o
+ * resultado sai nos primeiros ACKs.
+ */
+#include "config.h"
+#include "chanscan.h"
+#include "command.h"
+#include "heading.h"
+#include "hit.h"
+#include "hitpush.h"
+#include "buzzer.h"
+#include "laser.h"
+#include "lives.h"
+#include "nrf24.h"
+#include "odometry.h"
+#include "pairing.h"
+#include "pwm.h"
+#include "sched.h"
+#include "state.h"
+#include "telemetry.h"
+#include "thermal.h"
+
+#include <avr/interrupt.h>
+
+/* 250 ms sem comando (ticks de 10 ms). */
+#define MAIN_FAILSAFE_TICKS 25
+/* ACKs seguidos com a lista de canais, caso algum se perca. */
+#define MAIN_CHANNEL_REPEATS 3
+/* Segundos sem comando no link salvo, após ligar, até abrir o re-pareamento. */
+#define MAIN_REPAIR_WAIT_S 3
+
+/* Fora de linha para host/wcet.py medir cada tarefa (make wcet). */
+#define TASK static __attribute__((noinline))
+
+static struct command cmd;
+static uint8_t since_cmd = MAIN_FAILSAFE_TICKS;
+static uint8_t rx_count;
+static uint8_t link_quality;    /* pacotes no último segundo */
+static uint8_t boot_wait;       /* s até o re-pareamento do boot; 0 = não */
+static uint8_t freq_dirty;      /* frequência do PWM ainda não salva */
+
+static struct tlm_encoder tlm;
+
+static uint8_t chan_report[CHANSCAN_REPORT_SIZE];
+static uint8_t chan_len;
+static uint8_t chan_left;   /* ACKs que ainda levam a lista */
+
+static uint16_t tlm_flags(void)
+{
+    uint16_t f = 0;
+
+    if (CAR_IS_OUT())
+        f |= TLM_F_OUT;
+    if (CAR_DERATING())
+        f |= TLM_F_DERATING;
+    if (CAR_TEAMS())
+        f |= TLM_F_TEAMS;
+    f |= (uint16_t)CAR_TEAM() << TLM_F_TEAM_SHIFT;
+    f |= (uint16_t)CAR_GROUP_SLOT() << TLM_F_SLOT_SHIFT;
+    return f;
+}
+
+static void collect(int16_t v[TLM_FIELD_COUNT])
+{
+    v[TLM_LIVES] = CAR_LIVES();
+    v[TLM_FLAGS] = (int16_t)tlm_flags();
+    v[TLM_X_CM] = odometry_x_cm();
+    v[TLM_Y_CM] = odometry_y_cm();
+    v[TLM_THETA] = (int16_t)(odometry_theta() >> 8);
+    v[TLM_TEMP_C] = thermal_mosfet_q4() >> 4;
+    v[TLM_DERATE] = (int16_t)thermal_factor();
+    v[TLM_LINK] = link_quality;
+    v[TLM_AMMO] = laser_ammo_report();
+}
+
+/* Deixa um registro de telemetria pronto para o próximo ACK. */
+static void load_telemetry(void)
+{
+    int16_t v[TLM_FIELD_COUNT];
+    uint8_t buf[TLM_MAX_SIZE];
+    uint8_t n;
+
+    collect(v);
+    n = tlm_encode(&tlm, v, buf);
+    nrf24_flush_tx();
+    nrf24_write_ack(CMD_PIPE_PRIVATE, buf, n);
+}
+
+/* Payload do próximo ACK: a lista de canais, se pendente, ou telemetria. */
+static void load_ack(void)
+{
+    if (chan_left) {
+        chan_left--;
+        nrf24_flush_tx();
+        nrf24_write_ack(CMD_PIPE_PRIVATE, chan_report, chan_len);
+    } else {
+        load_telemetry();
+    }
+}
+
+/* Varredura do boot, com o rádio ainda fora de qualquer link. */
+static void scan_channels(void)
+{
+    uint8_t scores[NRF_CHANNELS];
+
+    chanscan_run(scores, CHANSCAN_PASSES);
+    chan_len = chanscan_report(chan_report, scores);
+    chan_left = MAIN_CHANNEL_REPEATS;
+}
+
+/* Para os motores e volta ao pareamento; o vínculo salvo fica de reserva. */
+static void repair(void)
+{
+    command_leave_group();
+    cmd.throttle = 0;
+    cmd.steer = 0;
+    since_cmd = MAIN_FAILSAFE_TICKS;
+    pwm_set(0, 0);
+    pairing_start();
+}
+
+TASK void radio_poll(void)
+{
+    uint8_t pkt[NRF_MAX_PAYLOAD];
+    uint8_t len, pipe, ack;
+
+    while ((len = nrf24_available(&pipe)) != 0) {   /* wcet-loop: 3 */
+        nrf24_read(pkt, len);
+        rx_count++;
+        if (command_decode(pkt, len, pipe, &cmd)) {
+            since_cmd = 0;
+            boot_wait = 0;
+            tlm_acked(&tlm, cmd.tlm_ack);
+            if (CMD_TEAM(cmd.flags) != hit_team())
+                hit_set_team(CMD_TEAM(cmd.flags));
+        } else if ((ack = command_poll_ack(pkt, len, pipe)) != 0) {
+            tlm_acked(&tlm, ack);
+        } else {
+            switch (command_control(pkt, len, pipe)) {
+            case CMD_CHANNELS:
+                chan_left = MAIN_CHANNEL_REPEATS;
+                break;
+            case CMD_REPAIR:
+                repair();
+                return;
+            case CMD_MATCH:
+                lives_reset();
+                laser_rearm();
+                odometry_reset(0, 0, 0);
+                break;
+            case CMD_PWM_FREQ:
+                if (pkt[1] < PWM_FREQ_COUNT) {
+                    pwm_set_freq((enum pwm_freq)pkt[1]);
+                    freq_dirty = 1;
+                }
+                break;
+            }
+        }
+        /* o ACK deste pacote já saiu; prepara o do próximo */
+        if (pipe == CMD_PIPE_PRIVATE && !hitpush_on_rx())
+            load_ack();
+    }
+}
+
+TASK void task_200hz(void)
+{
+    /* no pareamento o ACK é do HELLO/CONFIRM; um acerto o descartaria */
+    if (CAR_PAIRED())
+        hit_poll();
+}
+
+TASK void task_100hz(void)
+{
+    int16_t trim;
+
+    buzzer_tick();
+    if (!CAR_PAIRED()) {
+        if (pairing_poll() == PAIRING_DONE)
+            load_ack();
+        return;
+    }
+
+    if (since_cmd < MAIN_FAILSAFE_TICKS)
+        since_cmd++;
+    if (since_cmd >= MAIN_FAILSAFE_TICKS) {
+        cmd.throttle = 0;
+        cmd.steer = 0;
+    }
+    trim = heading_update(cmd.throttle, cmd.steer);
+    pwm_mix(cmd.throttle, cmd.steer, trim);
+
+    odometry_update();
+}
+
+TASK void task_10hz(void)
+{
+    /* duty efetivamente aplicado; sem sensor de corrente (0 = estimar) */
+    thermal_update(pwm_get_left(), pwm_get_right(), 0);
+}
+
+TASK void task_1hz(void)
+{
+    link_quality = rx_count;
+    rx_count = 0;
+    /* um byte de EEPROM por vez, sem esperar a gravação anterior */
+    if (freq_dirty && pwm_store_freq())
+        freq_dirty = 0;
+    /* vínculo salvo mudo desde o boot: talvez seja outro transmissor */
+    if (boot_wait && --boot_wait == 0 && CAR_PAIRED())
+        repair();
+}
+
+int main(void)
+{
+    struct binding b;
+    uint8_t last, now;
+    uint8_t n = 0, m = 0;
+
+    pwm_init(pwm_load_freq());
+    thermal_init();
+    buzzer_init();
+    laser_init();
+    lives_init();
+    hit_init();
+    odometry_init();
+    tlm_encoder_init(&tlm);
+    nrf24_init();
+    sched_init();
+    sei();
+
+    /* o giroscópio usa o TWI por interrupção */
+    heading_init();
+
+    scan_channels();
+    if (pairing_load(&b)) {
+        pairing_apply(&b);
+        load_ack();
+        boot_wait = MAIN_REPAIR_WAIT_S;
+    } else {
+        pairing_start();
+    }
+
+    last = sched_ticks();
+    for (;;) {
+        if (CAR_PAIRED())
+            radio_poll();
+
+        now = sched_ticks();
+        while (last != now) {
+            last++;
+            task_200hz();
+            if (last & 1)
+                task_100hz();
+            if (++m == SCHED_HZ / 10) {
+                m = 0;
+                task_10hz();
+            }
+            if (++n == SCHED_HZ) {
+                n = 0;
+                task_1hz();
+            }
+        }
+    }
+}
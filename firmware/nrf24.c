@@ -0,0 +1,197 @@
+#include "config.h"
+#include "nrf24.h"
+
+#include <avr/io.h>
+#include <util/delay.h>
+
+#define CMD_R_REGISTER   0x00
+#define CMD_W_REGISTER   0x20
+#define CMD_R_RX_PAYLOAD 0x61
+#define CMD_R_RX_PL_WID  0x60
+#define CMD_W_TX_PAYLOAD 0xA0
+#define CMD_W_TX_PAYLOAD_NOACK 0xB0
+#define CMD_W_ACK_PAYLOAD 0xA8
+#define CMD_FLUSH_TX     0xE1
+#define CMD_FLUSH_RX     0xE2
+#define CMD_NOP          0xFF
+
+#define REG_SETUP_AW   0x03
+#define REG_SETUP_RETR 0x04
+#define REG_RF_SETUP   0x06
+#define REG_DYNPD      0x1C
+#define REG_FEATURE    0x1D
+
+#define csn_low()  (NRF_PORT &= ~_BV(NRF_CSN_PIN))
+#define csn_high() (NRF_PORT |= _BV(NRF_CSN_PIN))
+
+static uint8_t spi(uint8_t b)
+{
+    SPDR = b;
+    /* SPI a F_CPU/2: 16 ciclos por byte */
+    loop_until_bit_is_set(SPSR, SPIF);   /* wcet-loop: 6 */
+    return SPDR;
+}
+
+static uint8_t command(uint8_t cmd)
+{
+    uint8_t status;
+
+    csn_low();
+    status = spi(cmd);
+    csn_high();
+    return status;
+}
+
+uint8_t nrf24_read_reg(uint8_t reg)
+{
+    uint8_t v;
+
+    csn_low();
+    spi(CMD_R_REGISTER | reg);
+    v = spi(CMD_NOP);
+    csn_high();
+    return v;
+}
+
+void nrf24_write_reg(uint8_t reg, uint8_t value)
+{
+    csn_low();
+    spi(CMD_W_REGISTER | reg);
+    spi(value);
+    csn_high();
+}
+
+static void write_buf(uint8_t cmd, const uint8_t *buf, uint8_t len)
+{
+    csn_low();
+    spi(cmd);
+    while (len--)   /* wcet-loop: NRF_MAX_PAYLOAD */
+        spi(*buf++);
+    csn_high();
+}
+
+void nrf24_init(void)
+{
+    NRF_PORT |= _BV(NRF_CSN_PIN);
+    NRF_PORT &= ~_BV(NRF_CE_PIN);
+    NRF_DDR |= _BV(NRF_CE_PIN) | _BV(NRF_CSN_PIN) | _BV(PB3) | _BV(PB5);
+
+    /* mestre, modo 0, F_CPU/2 (8 MHz, abaixo dos 10 MHz do rádio) */
+    SPCR = _BV(SPE) | _BV(MSTR);
+    SPSR = _BV(SPI2X);
+
+    _delay_ms(5);   /* power-on reset -> power down */
+
+    nrf24_write_reg(REG_SETUP_AW, 0x03);      /* endereços de 5 bytes */
+    nrf24_write_reg(REG_SETUP_RETR, 0x13);    /* 500 µs, 3 tentativas */
+    nrf24_write_reg(REG_RF_SETUP, 0x06);      /* 1 Mbps, 0 dBm */
+    nrf24_write_reg(REG_FEATURE, 0x07);       /* EN_DPL | EN_ACK_PAY | EN_DYN_ACK */
+    nrf24_write_reg(REG_DYNPD, 0x3F);
+    nrf24_write_reg(NRF_REG_EN_AA, 0x3F);
+    nrf24_flush_rx();
+    nrf24_flush_tx();
+    nrf24_write_reg(NRF_REG_STATUS, _BV(NRF_RX_DR) | _BV(NRF_TX_DS) |
+                                    _BV(NRF_MAX_RT));
+    /* CRC de 2 bytes, ligado, PRX */
+    nrf24_write_reg(NRF_REG_CONFIG, 0x0F);
+    _delay_ms(2);   /* Tpd2stby */
+}
+
+void nrf24_set_channel(uint8_t ch)
+{
+    nrf24_write_reg(NRF_REG_RF_CH, ch & 0x7F);
+}
+
+void nrf24_set_rx_addr(uint8_t pipe, const uint8_t *addr)
+{
+    write_buf(CMD_W_REGISTER | (NRF_REG_RX_ADDR_P0 + pipe), addr,
+              pipe < 2 ? NRF_ADDR_LEN : 1);
+}
+
+void nrf24_enable_pipes(uint8_t mask)
+{
+    nrf24_write_reg(NRF_REG_EN_RXADDR, mask);
+}
+
+void nrf24_listen(uint8_t on)
+{
+    if (on)
+        NRF_PORT |= _BV(NRF_CE_PIN);
+    else
+        NRF_PORT &= ~_BV(NRF_CE_PIN);
+}
+
+uint8_t nrf24_available(uint8_t *pipe)
+{
+    uint8_t status = command(CMD_NOP);
+    uint8_t p = (status >> 1) & 0x07;
+    uint8_t len;
+
+    if (p > 5)
+        return 0;   /* 7 = FIFO vazia */
+    csn_low();
+    spi(CMD_R_RX_PL_WID);
+    len = spi(CMD_NOP);
+    csn_high();
+    if (len == 0 || len > NRF_MAX_PAYLOAD) {
+        nrf24_flush_rx();
+        return 0;
+    }
+    *pipe = p;
+    return len;
+}
+
+void nrf24_read(uint8_t *buf, uint8_t len)
+{
+    csn_low();
+    spi(CMD_R_RX_PAYLOAD);
+    while (len--)   /* wcet-loop: NRF_MAX_PAYLOAD */
+        *buf++ = spi(CMD_NOP);
+    csn_high();
+    nrf24_write_reg(NRF_REG_STATUS, _BV(NRF_RX_DR));
+}
+
+void nrf24_write_ack(uint8_t pipe, const uint8_t *buf, uint8_t len)
+{
+    write_buf(CMD_W_ACK_PAYLOAD | pipe, buf, len);
+}
+
+uint8_t nrf24_send(const uint8_t addr[NRF_ADDR_LEN], const uint8_t *buf,
+                   uint8_t len)
+{
+    uint16_t n = NRF_SEND_TIMEOUT_US / 10;
+    uint8_t status;
+
+    nrf24_listen(0);
+    nrf24_write_reg(NRF_REG_CONFIG, 0x0E);     /* PTX */
+    write_buf(CMD_W_REGISTER | NRF_REG_TX_ADDR, addr, NRF_ADDR_LEN);
+    write_buf(CMD_W_REGISTER | NRF_REG_RX_ADDR_P0, addr, NRF_ADDR_LEN);
+    nrf24_flush_tx();
+    write_buf(CMD_W_TX_PAYLOAD, buf, len);
+
+    NRF_PORT |= _BV(NRF_CE_PIN);
+    _delay_us(15);                             /* pulso mínimo de 10 µs */
+    NRF_PORT &= ~_BV(NRF_CE_PIN);
+
+    do {
+        status = command(CMD_NOP);
+        if (status & (_BV(NRF_TX_DS) | _BV(NRF_MAX_RT)))
+            break;
+        _delay_us(10);
+    } while (--n);   /* wcet-loop: NRF_SEND_TIMEOUT_US / 10 */
+
+    nrf24_write_reg(NRF_REG_STATUS, _BV(NRF_RX_DR) | _BV(NRF_TX_DS) |
+                                    _BV(NRF_MAX_RT));
+    nrf24_flush_tx();
+    nrf24_flush_rx();                          /* eventual payload do ACK */
+    nrf24_write_reg(NRF_REG_CONFIG, 0x0F);     /* de volta a PRX */
+    return (status & _BV(NRF_TX_DS)) != 0;
+}
+
+void nrf24_write_tx_noack(const uint8_t *buf, uint8_t len)
+{
+    write_buf(CMD_W_TX_PAYLOAD_NOACK, buf, len);
+}
+
+void nrf24_flush_rx(void) { command(CMD_FLUSH_RX); }
+void nrf24_flush_tx(void) { command(CMD_FLUSH_TX); }
@@ -0,0 +1,77 @@
+/*
+ * Acesso ao NRF24L01 pelo SPI de hardware.
+ *
+ * O carrinho fica como receptor (PRX) com payload dinâmico e payload no ACK:
+ * respostas ao transmissor viajam no ACK do próximo pacote recebido. Só o
+ * pareamento transmite por conta própria (nrf24_send()).
+ */
+#ifndef NRF24_H
+#define NRF24_H
+
+#include <stdint.h>
+
+#define NRF_ADDR_LEN     5
+#define NRF_MAX_PAYLOAD  32
+
+/* Registradores usados fora do driver. */
+#define NRF_REG_CONFIG      0x00
+#define NRF_REG_EN_AA       0x01
+#define NRF_REG_EN_RXADDR   0x02
+#define NRF_REG_RF_CH       0x05
+#define NRF_REG_STATUS      0x07
+#define NRF_REG_RPD         0x09
+#define NRF_REG_RX_ADDR_P0  0x0A
+#define NRF_REG_TX_ADDR     0x10
+#define NRF_REG_FIFO_STATUS 0x17
+
+/* Bits de STATUS. */
+#define NRF_RX_DR   6
+#define NRF_TX_DS   5
+#define NRF_MAX_RT  4
+
+void nrf24_init(void);
+
+uint8_t nrf24_read_reg(uint8_t reg);
+void nrf24_write_reg(uint8_t reg, uint8_t value);
+
+void nrf24_set_channel(uint8_t ch);
+
+/* Pipes 0 e 1 recebem endereço completo; 2..5 só o último byte. */
+void nrf24_set_rx_addr(uint8_t pipe, const uint8_t *addr);
+void nrf24_enable_pipes(uint8_t mask);
+
+/* Liga/desliga a recepção (pino CE). */
+void nrf24_listen(uint8_t on);
+
+/*
+ * Se há pacote na FIFO, retorna o tamanho e o pipe de origem; 0 se vazia.
+ * Pacotes de tamanho inválido são descartados.
+ */
+uint8_t nrf24_available(uint8_t *pipe);
+void nrf24_read(uint8_t *buf, uint8_t len);
+
+/* Carrega o payload que vai no próximo ACK enviado pelo pipe. */
+void nrf24_write_ack(uint8_t pipe, const uint8_t *buf, uint8_t len);
+
+/*
+ * Envia um pacote como PTX, com auto-ACK, e espera o resultado por no
+ * máximo NRF_SEND_TIMEOUT_US. Volta para PRX com CE em 0; o chamador
+ * restaura o endereço do pipe 0 (usado para receber o ACK) e a recepção.
+ * Retorna 1 se o destino confirmou.
+ */
+#ifndef NRF_SEND_TIMEOUT_US
+#define NRF_SEND_TIMEOUT_US 5000
+#endif
+uint8_t nrf24_send(const uint8_t addr[NRF_ADDR_LEN], const uint8_t *buf,
+                   uint8_t len);
+
+/*
+ * Lado do transmissor: coloca um pacote que o destino não deve confirmar
+ * (OFFER do pareamento, comando de grupo). Depende de EN_DYN_ACK.
+ */
+void nrf24_write_tx_noack(const uint8_t *buf, uint8_t len);
+
+void nrf24_flush_rx(void);
+void nrf24_flush_tx(void);
+
+#endif /* NRF24_H */
@@ -0,0 +1,128 @@
+#include "config.h"
+#include "odometry.h"
+#include "pwm.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include "progmem.h"
+
+#if USE_GYRO
+#include "gyro.h"
+#endif
+
+/* Um quarto de seno, 64 passos, Q14. */
+static const int16_t sin_table[65] PROGMEM = {
+    0, 402, 804, 1205, 1606, 2006, 2404, 2801,
+    3196, 3590, 3981, 4370, 4756, 5139, 5520, 5897,
+    6270, 6639, 7005, 7366, 7723, 8076, 8423, 8765,
+    9102, 9434, 9760, 10080, 10394, 10702, 11003, 11297,
+    11585, 11866, 12140, 12406, 12665, 12916, 13160, 13395,
+    13623, 13842, 14053, 14256, 14449, 14635, 14811, 14978,
+    15137, 15286, 15426, 15557, 15679, 15791, 15893, 15986,
+    16069, 16143, 16207, 16261, 16305, 16340, 16364, 16379,
+    16384,
+};
+
+static int32_t pos_x;
+static int32_t pos_y;
+static uint16_t theta;
+
+#if USE_ENCODERS
+static volatile uint8_t enc_l, enc_r;
+static uint8_t enc_last;
+static uint8_t seen_l, seen_r;
+#endif
+
+/* seno Q14 com interpolação linear entre as entradas da tabela */
+static int16_t sin_bam(uint16_t a)
+{
+    uint16_t pos = a & 0x3FFF;
+    uint8_t i, frac;
+    int16_t v;
+
+    if (a & 0x4000)
+        pos = 0x4000 - pos;
+    i = (uint8_t)(pos >> 8);
+    frac = (uint8_t)pos;
+    v = pgm_i16(&sin_table[i]);
+    if (frac)
+        v += (int16_t)(((int32_t)(pgm_i16(&sin_table[i + 1]) - v) * frac) >> 8);
+    return (a & 0x8000) ? -v : v;
+}
+
+void odometry_init(void)
+{
+#if USE_ENCODERS
+    PCMSK2 |= _BV(ENC_L_PIN) | _BV(ENC_R_PIN);
+    PCICR |= _BV(PCIE2);
+    enc_last = ENC_PORT_PIN;
+    seen_l = enc_l;
+    seen_r = enc_r;
+#endif
+    odometry_reset(0, 0, 0);
+}
+
+void odometry_reset(int16_t x_mm, int16_t y_mm, uint16_t t)
+{
+    pos_x = (int32_t)x_mm * 256;
+    pos_y = (int32_t)y_mm * 256;
+    theta = t;
+}
+
+void odometry_update(void)
+{
+    int32_t dl, dr, d;
+    int16_t dtheta;
+    uint16_t mid;
+
+#if USE_ENCODERS
+    uint8_t l = enc_l, r = enc_r;   /* leitura de 8 bits é atômica */
+
+    /* Sem sentido de giro (MOSFET único por motor): sempre para a frente. */
+    dl = (int32_t)(uint8_t)(l - seen_l) * ODOM_ENC_Q8_PER_TICK;
+    dr = (int32_t)(uint8_t)(r - seen_r) * ODOM_ENC_Q8_PER_TICK;
+    seen_l = l;
+    seen_r = r;
+#else
+    dl = (int32_t)pwm_get_left() * ODOM_VMAX_MM_S * 256 / (255L * ODOM_TICK_HZ);
+    dr = (int32_t)pwm_get_right() * ODOM_VMAX_MM_S * 256 / (255L * ODOM_TICK_HZ);
+#endif
+
+#if USE_GYRO
+    if (gyro_ready() && gyro_fresh())
+        dtheta = (int16_t)((int32_t)gyro_rate() * 65536L /
+                           ((int32_t)GYRO_LSB_PER_DPS * 360 * ODOM_TICK_HZ));
+    else
+#endif
+        /* 65536 / 2π = 10430 BAM por radiano */
+        dtheta = (int16_t)((dr - dl) * 10430L / (ODOM_WHEELBASE_MM * 256L));
+
+    /* integra no ângulo médio do passo (segunda ordem de Runge-Kutta) */
+    mid = theta + (uint16_t)(dtheta / 2);
+    d = (dl + dr) / 2;
+    pos_x += (d * sin_bam(mid + 0x4000)) >> 14;
+    pos_y += (d * sin_bam(mid)) >> 14;
+    theta += (uint16_t)dtheta;
+}
+
+int32_t odometry_x_q8(void)   { return pos_x; }
+int32_t odometry_y_q8(void)   { return pos_y; }
+uint16_t odometry_theta(void) { return theta; }
+
+/* mm Q8 -> cm: dividir por 2560 */
+int16_t odometry_x_cm(void)   { return (int16_t)(pos_x / 2560); }
+int16_t odometry_y_cm(void)   { return (int16_t)(pos_y / 2560); }
+
+#if USE_ENCODERS
+ISR(PCINT2_vect)
+{
+    uint8_t now = ENC_PORT_PIN;
+    uint8_t rise = now & (uint8_t)~enc_last;
+
+    enc_last = now;
+    if (rise & _BV(ENC_L_PIN))
+        enc_l++;
+    if (rise & _BV(ENC_R_PIN))
+        enc_r++;
+}
+#endif
@@ -0,0 +1,46 @@
+/*
+ * Odometria e estimativa de posição (dead reckoning) em ponto fixo.
+ *
+ * Posição em mm Q8, ângulo em BAM (65536 = uma volta, 0 = eixo X da arena,
+ * positivo = anti-horário). O deslocamento de cada roda vem dos encoders,
+ * se existirem, ou do duty do PWM; o giro vem do giroscópio quando
+ * calibrado, senão da diferença entre as rodas.
+ */
+#ifndef ODOMETRY_H
+#define ODOMETRY_H
+
+#include <stdint.h>
+
+#ifndef ODOM_TICK_HZ
+#define ODOM_TICK_HZ        100
+#endif
+/* Distância entre as rodas. */
+#ifndef ODOM_WHEELBASE_MM
+#define ODOM_WHEELBASE_MM   120
+#endif
+/* Velocidade de cada roda com duty 255 (estimativa sem encoder). */
+#ifndef ODOM_VMAX_MM_S
+#define ODOM_VMAX_MM_S      600
+#endif
+/* Deslocamento por pulso de encoder, mm Q8. */
+#ifndef ODOM_ENC_Q8_PER_TICK
+#define ODOM_ENC_Q8_PER_TICK (5 * 256)
+#endif
+
+void odometry_init(void);
+
+/* Zera a pose em (x, y) mm com o ângulo dado (início da partida). */
+void odometry_reset(int16_t x_mm, int16_t y_mm, uint16_t theta);
+
+/* Chamar a ODOM_TICK_HZ. */
+void odometry_update(void);
+
+int32_t odometry_x_q8(void);
+int32_t odometry_y_q8(void);
+uint16_t odometry_theta(void);
+
+/* Posição em cm para a telemetria (TLM_X_CM/TLM_Y_CM); cobre ±327 m. */
+int16_t odometry_x_cm(void);
+int16_t odometry_y_cm(void);
+
+#endif /* ODOMETRY_H */
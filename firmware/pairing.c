@@ -0,0 +1,265 @@
+#include "config.h"
+#include "adc.h"
+#include "pairing.h"
+#include "state.h"
+
+#include <avr/eeprom.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <string.h>
+
+#define BINDING_MAGIC 0xB1
+
+struct stored_binding {
+    uint8_t magic;
+    struct binding b;
+    uint8_t crc;
+};
+
+static struct stored_binding ee_binding EEMEM;
+static uint32_t ee_car_id EEMEM;
+
+static uint8_t ticks;
+static uint8_t rnd;
+static uint32_t car_id;
+static uint8_t tx_addr[NRF_ADDR_LEN];
+static struct binding pending;
+static struct binding saved;   /* vínculo em uso, para a janela de re-pareamento */
+static uint8_t has_saved;
+static uint16_t window;
+
+static uint8_t crc8(const uint8_t *p, uint8_t len)
+{
+    uint8_t crc = 0, i;
+
+    while (len--) {   /* wcet-loop: 16 */
+        crc ^= *p++;
+        for (i = 0; i < 8; i++)   /* wcet-loop: 8 */
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+/*
+ * Id único do carrinho, sorteado uma vez. O ruído dos bits baixos do sensor
+ * de temperatura e o Timer0 livre servem de semente.
+ */
+static uint32_t load_car_id(void)
+{
+    uint32_t id;
+    uint8_t i;
+
+    eeprom_read_block(&id, &ee_car_id, sizeof(id));
+    if (id != 0xFFFFFFFFUL && id != 0)
+        return id;
+
+    adc_init();
+    id = 0;
+    for (i = 0; i < 32; i++)   /* wcet-loop: 32 */
+        id = (id << 1 | id >> 31) ^
+             adc_read(ADC_REF_1V1 | ADC_CH_TEMP_INTERNAL) ^ TCNT0;
+    if (id == 0xFFFFFFFFUL || id == 0)
+        id = 0x5A5A5A5AUL;
+    eeprom_update_block(&id, &ee_car_id, sizeof(id));
+    return id;
+}
+
+static void put_id(uint8_t *p)
+{
+    memcpy(p, &car_id, sizeof(car_id));
+}
+
+static uint8_t id_matches(const uint8_t *p)
+{
+    return memcmp(p, &car_id, sizeof(car_id)) == 0;
+}
+
+static void preload_ack(uint8_t type)
+{
+    uint8_t pkt[1 + sizeof(car_id)];
+
+    pkt[0] = type;
+    put_id(pkt + 1);
+    nrf24_flush_tx();
+    nrf24_write_ack(0, pkt, sizeof(pkt));
+}
+
+uint8_t pairing_load(struct binding *b)
+{
+    struct stored_binding s;
+
+    eeprom_read_block(&s, &ee_binding, sizeof(s));
+    if (s.magic != BINDING_MAGIC ||
+        s.crc != crc8((const uint8_t *)&s.b, sizeof(s.b)))
+        return 0;
+    *b = s.b;
+    saved = s.b;
+    has_saved = 1;
+    CAR_SET_PAIRED(1);
+    return 1;
+}
+
+void pairing_apply(const struct binding *b)
+{
+    nrf24_listen(0);
+    nrf24_set_channel(b->channel);
+    nrf24_set_rx_addr(0, b->addr);
+    nrf24_enable_pipes(0x01);
+    nrf24_flush_rx();
+    nrf24_flush_tx();
+    nrf24_listen(1);
+}
+
+/* endereço próprio do carrinho durante o pareamento */
+static void car_addr(uint8_t addr[NRF_ADDR_LEN])
+{
+    addr[0] = PAIR_CAR_ADDR_PREFIX;
+    memcpy(addr + 1, &car_id, sizeof(car_id));
+}
+
+static void listen_offer(void)
+{
+    static const uint8_t pair_addr_P[NRF_ADDR_LEN] PROGMEM = NRF_PAIR_ADDR;
+    uint8_t addr[NRF_ADDR_LEN];
+
+    nrf24_listen(0);
+    memcpy_P(addr, pair_addr_P, NRF_ADDR_LEN);
+    nrf24_set_rx_addr(0, addr);
+    nrf24_flush_rx();
+    nrf24_flush_tx();
+    nrf24_listen(1);
+    CAR_SET_PAIR_STATE(PAIRING_WAIT_OFFER);
+}
+
+/* LFSR de 8 bits (x^8 + x^6 + x^5 + x^4 + 1) para a espera aleatória */
+static uint8_t random8(void)
+{
+    rnd = (uint8_t)((rnd >> 1) ^ (-(rnd & 1) & 0xB8));
+    return rnd;
+}
+
+void pairing_start(void)
+{
+    if (car_id == 0)
+        car_id = load_car_id();
+    rnd = (uint8_t)(car_id ^ (car_id >> 8) ^ TCNT0);
+    if (rnd == 0)
+        rnd = 1;
+    CAR_SET_PAIRED(0);
+    window = 0;
+    nrf24_listen(0);
+    nrf24_set_channel(NRF_PAIR_CHANNEL);
+    nrf24_enable_pipes(0x01);
+    listen_offer();
+}
+
+static void save(void)
+{
+    struct stored_binding s;
+
+    s.magic = BINDING_MAGIC;
+    s.b = pending;
+    s.crc = crc8((const uint8_t *)&s.b, sizeof(s.b));
+    eeprom_update_block(&s, &ee_binding, sizeof(s));
+}
+
+/* Manda o HELLO e passa a escutar só no endereço do carrinho. */
+static void send_hello(void)
+{
+    uint8_t pkt[1 + sizeof(car_id)];
+    uint8_t addr[NRF_ADDR_LEN];
+
+    pkt[0] = PAIR_HELLO;
+    put_id(pkt + 1);
+    if (!nrf24_send(tx_addr, pkt, sizeof(pkt))) {
+        listen_offer();
+        return;
+    }
+    car_addr(addr);
+    nrf24_set_rx_addr(0, addr);
+    preload_ack(PAIR_HELLO);
+    nrf24_listen(1);
+    CAR_SET_PAIR_STATE(PAIRING_WAIT_ASSIGN);
+}
+
+static void handle(const uint8_t *pkt, uint8_t len)
+{
+    switch (pkt[0]) {
+    case PAIR_OFFER:
+        if (CAR_PAIR_STATE() != PAIRING_WAIT_OFFER ||
+            len < 1 + NRF_ADDR_LEN)
+            break;
+        memcpy(tx_addr, pkt + 1, NRF_ADDR_LEN);
+        ticks = (uint8_t)(random8() & (PAIRING_BACKOFF_MAX - 1)) + 1;
+        CAR_SET_PAIR_STATE(PAIRING_BACKOFF);
+        break;
+    case PAIR_ASSIGN:
+        if (CAR_PAIR_STATE() != PAIRING_WAIT_ASSIGN ||
+            len < 1 + 4 + NRF_ADDR_LEN + 1 + 2 + PAIR_KEY_LEN ||
+            !id_matches(pkt + 1))
+            break;
+        pkt += 5;
+        memcpy(pending.addr, pkt, NRF_ADDR_LEN);
+        pkt += NRF_ADDR_LEN;
+        pending.channel = *pkt++ & 0x7F;
+        pending.hop_seed = (uint16_t)(pkt[0] | (uint16_t)pkt[1] << 8);
+        memcpy(pending.key, pkt + 2, PAIR_KEY_LEN);
+        preload_ack(PAIR_CONFIRM);
+        CAR_SET_PAIR_STATE(PAIRING_WAIT_COMMIT);
+        break;
+    case PAIR_COMMIT:
+        if (CAR_PAIR_STATE() != PAIRING_WAIT_COMMIT || len < 5 ||
+            !id_matches(pkt + 1))
+            break;
+        CAR_SET_PAIR_STATE(PAIRING_DONE);
+        break;
+    }
+}
+
+enum pairing_state pairing_poll(void)
+{
+    uint8_t pkt[NRF_MAX_PAYLOAD];
+    uint8_t len, pipe;
+    uint8_t state = CAR_PAIR_STATE();
+
+    switch (state) {
+    case PAIRING_IDLE:
+    case PAIRING_DONE:
+        return (enum pairing_state)state;
+    case PAIRING_BACKOFF:
+        if (--ticks == 0) {
+            send_hello();
+            ticks = 0;
+        }
+        return (enum pairing_state)CAR_PAIR_STATE();
+    }
+
+    while ((len = nrf24_available(&pipe)) != 0) {   /* wcet-loop: 3 */
+        nrf24_read(pkt, len);
+        handle(pkt, len);
+    }
+
+    state = CAR_PAIR_STATE();
+    if (state == PAIRING_DONE) {
+        /* o CONFIRM saiu no ACK do COMMIT; já dá para trocar de link */
+        save();
+        pairing_apply(&pending);
+        saved = pending;
+        has_saved = 1;
+        CAR_SET_PAIRED(1);
+    } else if (state == PAIRING_WAIT_OFFER && has_saved &&
+               ++window >= PAIRING_WINDOW_TICKS) {
+        /* ninguém pareou na janela: volta ao vínculo salvo */
+        pairing_apply(&saved);
+        CAR_SET_PAIRED(1);
+        CAR_SET_PAIR_STATE(PAIRING_DONE);
+        state = PAIRING_DONE;
+    } else if (state != PAIRING_WAIT_OFFER &&
+               ++ticks >= PAIRING_TIMEOUT_TICKS) {
+        listen_offer();
+        state = PAIRING_WAIT_OFFER;
+    }
+    return (enum pairing_state)state;
+}
+
+uint32_t pairing_car_id(void) { return car_id; }
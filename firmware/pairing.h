@@ -0,0 +1,97 @@
+/*
+ * Pareamento rápido transmissor <-> carrinho.
+ *
+ *   1. TX -> OFFER (endereço do TX)   no endereço de pareamento, sem ACK
+ *   2. espera aleatória no carrinho, depois
+ *      carro -> HELLO (id)           para o endereço do TX, com ACK
+ *   3. TX -> ASSIGN (id, link)        no endereço do carrinho  ACK <- HELLO
+ *   4. TX -> COMMIT (id)              no endereço do carrinho  ACK <- CONFIRM
+ *
+ * Só o OFFER usa o endereço compartilhado (config.h), e vai sem ACK
+ * (W_TX_PAYLOAD_NOACK), então carrinhos em pareamento nunca respondem ao
+ * mesmo tempo no ar. A espera aleatória espalha os HELLOs de vários
+ * carrinhos que ouviram o mesmo OFFER. A partir do HELLO cada carrinho
+ * escuta só no seu endereço, derivado do id, e os payloads de ACK não se
+ * misturam entre pares. Após o COMMIT o vínculo vai para a EEPROM e o
+ * rádio passa para o link privado.
+ *
+ * Re-pareamento: o transmissor do vínculo manda CMD_REPAIR (command.h), ou
+ * o link salvo fica mudo nos primeiros segundos após ligar (main.c). O
+ * carrinho volta a esperar OFFER, mas o vínculo salvo continua valendo:
+ * se nenhum pareamento novo terminar em PAIRING_WINDOW_TICKS, ele volta ao
+ * link antigo.
+ */
+#ifndef PAIRING_H
+#define PAIRING_H
+
+#include <stdint.h>
+
+#include "nrf24.h"
+
+#define PAIR_OFFER    0x50
+#define PAIR_HELLO    0x51
+#define PAIR_ASSIGN   0x52
+#define PAIR_CONFIRM  0x53
+#define PAIR_COMMIT   0x54
+
+#define PAIR_KEY_LEN  8
+
+/* Primeiro byte do endereço do carrinho; os outros 4 são o id. */
+#define PAIR_CAR_ADDR_PREFIX 0xC3
+
+/*
+ * Prazo do aperto de mão depois do OFFER (ticks de 10 ms). Esgotado, o
+ * carrinho volta a esperar OFFER.
+ */
+#ifndef PAIRING_TIMEOUT_TICKS
+#define PAIRING_TIMEOUT_TICKS 100
+#endif
+/* Janela de re-pareamento com vínculo salvo (ticks de 10 ms, 10 s). */
+#ifndef PAIRING_WINDOW_TICKS
+#define PAIRING_WINDOW_TICKS 1000
+#endif
+/* Espera antes do HELLO: 1..PAIRING_BACKOFF_MAX ticks. Potência de 2. */
+#ifndef PAIRING_BACKOFF_MAX
+#define PAIRING_BACKOFF_MAX 8
+#endif
+
+/*
+ * hop_seed e key vêm no ASSIGN e ficam salvos, mas estão reservados: o
+ * link ainda não salta de canal nem autentica os pacotes. Ficam no
+ * formato para que um firmware futuro use o mesmo vínculo sem novo
+ * pareamento.
+ */
+struct binding {
+    uint8_t addr[NRF_ADDR_LEN];
+    uint8_t channel;
+    uint16_t hop_seed;             /* reservado */
+    uint8_t key[PAIR_KEY_LEN];     /* reservado */
+};
+
+enum pairing_state {
+    PAIRING_IDLE,
+    PAIRING_WAIT_OFFER,
+    PAIRING_BACKOFF,
+    PAIRING_WAIT_ASSIGN,
+    PAIRING_WAIT_COMMIT,
+    PAIRING_DONE
+};
+
+/* Lê o vínculo salvo; retorna 0 se a EEPROM não tem um válido. */
+uint8_t pairing_load(struct binding *b);
+
+/* Sintoniza o rádio no link privado do vínculo. */
+void pairing_apply(const struct binding *b);
+
+/*
+ * Entra no modo de pareamento (canal e endereço conhecidos). Também serve
+ * para re-parear um carrinho já vinculado.
+ */
+void pairing_start(void);
+
+/* Chamar a cada 10 ms até retornar PAIRING_DONE. */
+enum pairing_state pairing_poll(void);
+
+uint32_t pairing_car_id(void);
+
+#endif /* PAIRING_H */
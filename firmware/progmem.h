@@ -0,0 +1,28 @@
+/*
+ * Leitura tipada de tabelas em flash.
+ *
+ * pgm_read_* devolve inteiros sem sinal; estes wrappers fixam o tipo de
+ * cada tabela e evitam casts espalhados (e erros de sinal) nos módulos.
+ */
+#ifndef PROGMEM_H
+#define PROGMEM_H
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+static inline uint8_t pgm_u8(const uint8_t *p)
+{
+    return pgm_read_byte(p);
+}
+
+static inline uint16_t pgm_u16(const uint16_t *p)
+{
+    return pgm_read_word(p);
+}
+
+static inline int16_t pgm_i16(const int16_t *p)
+{
+    return (int16_t)pgm_read_word(p);
+}
+
+#endif /* PROGMEM_H */
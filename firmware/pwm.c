@@ -0,0 +1,147 @@
+#include "config.h"
+#include "pwm.h"
+#include "state.h"
+#include "thermal.h"
+
+#include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+#include "progmem.h"
+
+#define WGM_FAST   (_BV(WGM01) | _BV(WGM00))
+#define WGM_PHASE  _BV(WGM00)
+
+#define CS_1    _BV(CS00)
+#define CS_8    _BV(CS01)
+#define CS_64   (_BV(CS01) | _BV(CS00))
+#define CS_256  _BV(CS02)
+
+/* TCCR0A (só bits WGM) e TCCR0B (prescaler) para cada frequência. */
+#define FREQ_ENTRY(name, phase, div) \
+    [PWM_FREQ_##name] = { (phase) ? WGM_PHASE : WGM_FAST, CS_##div },
+static const uint8_t freq_table[PWM_FREQ_COUNT][2] PROGMEM = {
+    PWM_MODES(FREQ_ENTRY)
+};
+#undef FREQ_ENTRY
+
+static uint8_t ee_freq EEMEM = MOTOR_PWM_DEFAULT;
+
+static volatile uint8_t cur_freq;
+static volatile uint8_t pending_freq;
+static uint8_t duty_left;
+static uint8_t duty_right;
+
+/* Bits COM0x conforme o duty: com 0 a saída fica desligada e o pino em 0. */
+static uint8_t com_bits(void)
+{
+    uint8_t com = 0;
+
+    if (duty_left)
+        com |= _BV(COM0A1);
+    if (duty_right)
+        com |= _BV(COM0B1);
+    return com;
+}
+
+void pwm_init(enum pwm_freq freq)
+{
+    MOTOR_PORT &= ~(_BV(MOTOR_L_PIN) | _BV(MOTOR_R_PIN));
+    MOTOR_DDR |= _BV(MOTOR_L_PIN) | _BV(MOTOR_R_PIN);
+
+    duty_left = 0;
+    duty_right = 0;
+    OCR0A = 0;
+    OCR0B = 0;
+    cur_freq = freq;
+    pending_freq = freq;
+    TCNT0 = 0;
+    TCCR0A = pgm_u8(&freq_table[freq][0]);
+    TCCR0B = pgm_u8(&freq_table[freq][1]);
+}
+
+void pwm_set(uint8_t left, uint8_t right)
+{
+    uint8_t sreg;
+
+    /* derating térmico em todo caminho que chega aos motores */
+    left = thermal_derate(left);
+    right = thermal_derate(right);
+    /* fora do jogo os motores ficam parados, venha de onde vier */
+    if (CAR_IS_OUT())
+        left = right = 0;
+
+    sreg = SREG;
+    cli();
+    duty_left = left;
+    duty_right = right;
+    OCR0A = left;
+    OCR0B = right;
+    TCCR0A = (TCCR0A & (_BV(WGM01) | _BV(WGM00))) | com_bits();
+    SREG = sreg;
+}
+
+static uint8_t sat_u8(int16_t v)
+{
+    if (v < 0)
+        return 0;
+    if (v > 255)
+        return 255;
+    return (uint8_t)v;
+}
+
+void pwm_mix(uint8_t throttle, int8_t steer, int16_t trim)
+{
+    int16_t turn = (int16_t)steer + trim;
+
+    pwm_set(sat_u8((int16_t)throttle + turn), sat_u8((int16_t)throttle - turn));
+}
+
+void pwm_set_freq(enum pwm_freq freq)
+{
+    if (freq >= PWM_FREQ_COUNT)
+        return;
+    pending_freq = freq;
+    if (freq != cur_freq) {
+        TIFR0 = _BV(TOV0);
+        TIMSK0 |= _BV(TOIE0);
+    }
+}
+
+enum pwm_freq pwm_load_freq(void)
+{
+    uint8_t f = eeprom_read_byte(&ee_freq);
+
+    /* EEPROM apagada (0xFF) ou valor de outra versão */
+    return f < PWM_FREQ_COUNT ? (enum pwm_freq)f : MOTOR_PWM_DEFAULT;
+}
+
+uint8_t pwm_store_freq(void)
+{
+    if (!eeprom_is_ready())
+        return 0;
+    eeprom_update_byte(&ee_freq, pending_freq);
+    return 1;
+}
+
+enum pwm_freq pwm_get_freq(void) { return (enum pwm_freq)cur_freq; }
+uint8_t pwm_get_left(void)       { return duty_left; }
+uint8_t pwm_get_right(void)      { return duty_right; }
+
+/*
+ * TOV0 acontece no BOTTOM (nos dois modos), quando o período anterior já
+ * terminou: é o ponto seguro para trocar modo e prescaler.
+ */
+ISR(TIMER0_OVF_vect)
+{
+    uint8_t f = pending_freq;
+
+    TIMSK0 &= ~_BV(TOIE0);
+    if (f == cur_freq)
+        return;
+    TCCR0B = 0;
+    TCNT0 = 0;
+    TCCR0A = pgm_u8(&freq_table[f][0]) | com_bits();
+    TCCR0B = pgm_u8(&freq_table[f][1]);
+    cur_freq = f;
+}
@@ -0,0 +1,66 @@
+/*
+ * PWM dos motores (Timer0) com troca de frequência em tempo de execução.
+ *
+ * A frequência é escolhida numa tabela de combinações modo/prescaler. A
+ * troca pedida por pwm_set_freq() só é aplicada no BOTTOM do contador, na
+ * interrupção de overflow, para não cortar nem esticar o período corrente.
+ */
+#ifndef PWM_H
+#define PWM_H
+
+#include <stdint.h>
+
+/*
+ * Modos do Timer0, X(nome, phase-correct, prescaler); o nome é a frequência
+ * a 16 MHz. A mesma lista monta a tabela de pwm.c e alimenta o modelo de
+ * host (host/pwm_model.c).
+ */
+#define PWM_MODES(X)  \
+    X(62K5, 0, 1)     \
+    X(31K4, 1, 1)     \
+    X(7K8,  0, 8)     \
+    X(3K9,  1, 8)     \
+    X(977,  0, 64)    \
+    X(490,  1, 64)    \
+    X(244,  0, 256)
+
+#define PWM_FREQ_ENUM(name, phase, div) PWM_FREQ_##name,
+enum pwm_freq {
+    PWM_MODES(PWM_FREQ_ENUM)
+    PWM_FREQ_COUNT
+};
+#undef PWM_FREQ_ENUM
+
+void pwm_init(enum pwm_freq freq);
+
+/*
+ * Duty de 0 a 255, reduzido pelo fator de thermal_derate(); 0 desliga a
+ * saída de fato (sem o pulso de 1 ciclo). pwm_get_*() devolvem o duty já
+ * aplicado.
+ */
+void pwm_set(uint8_t left, uint8_t right);
+
+/*
+ * Mixer diferencial: throttle 0..255, steer -128..127 (positivo = direita) e
+ * uma correção extra (ex.: heading_update()) somada como steer. Satura em
+ * 0..255 e chama pwm_set().
+ */
+void pwm_mix(uint8_t throttle, int8_t steer, int16_t trim);
+
+/* Agenda a troca de frequência; não bloqueia. */
+void pwm_set_freq(enum pwm_freq freq);
+
+/*
+ * Frequência de cada carrinho, escolhida pelo transmissor (CMD_PWM_FREQ) e
+ * guardada na EEPROM. pwm_load_freq() devolve a salva, ou
+ * MOTOR_PWM_DEFAULT se não houver. pwm_store_freq() grava a pedida sem
+ * esperar: com a EEPROM ocupada retorna 0 e o chamador tenta de novo.
+ */
+enum pwm_freq pwm_load_freq(void);
+uint8_t pwm_store_freq(void);
+
+enum pwm_freq pwm_get_freq(void);
+uint8_t pwm_get_left(void);
+uint8_t pwm_get_right(void);
+
+#endif /* PWM_H */
@@ -0,0 +1,32 @@
+#include "config.h"
+#include "laser.h"
+#include "sched.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+/* Prescaler 64: 250 kHz, 5 ms = 1250 contagens exatas a 16 MHz. */
+#define T1_TOP ((uint16_t)(F_CPU / 64 / SCHED_HZ - 1))
+
+static volatile uint8_t ticks;
+
+void sched_init(void)
+{
+    TCCR1A = 0;
+    TCCR1B = _BV(WGM12) | _BV(CS11) | _BV(CS10);   /* CTC com OCR1A, /64 */
+    OCR1A = T1_TOP;
+    TCNT1 = 0;
+    TIMSK1 = _BV(OCIE1A);
+}
+
+uint8_t sched_ticks(void)
+{
+    return ticks;   /* leitura de 8 bits é atômica */
+}
+
+ISR(TIMER1_COMPA_vect)
+{
+    /* laser primeiro: a borda do tiro não espera a contabilidade */
+    laser_tick();
+    ticks++;
+}
@@ -0,0 +1,20 @@
+/*
+ * Tick do sistema no Timer1.
+ *
+ * Timer1 em CTC gera uma interrupção a cada 5 ms (200 Hz). O ISR cuida do
+ * laser (laser_tick(), tempo constante) e conta ticks; o laço principal em
+ * main.c consome os ticks e roda as tarefas periódicas fora de interrupção.
+ */
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+
+#define SCHED_HZ 200
+
+void sched_init(void);
+
+/* Contador livre de ticks (8 bits, dá a volta a cada 1,28 s). */
+uint8_t sched_ticks(void);
+
+#endif /* SCHED_H */
@@ -0,0 +1,6 @@
+#include "state.h"
+
+struct car_state car = {
+    .lives = 3,
+    .group_slot = CAR_NO_SLOT,
+};
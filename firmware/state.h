@@ -0,0 +1,54 @@
+/*
+ * Estado do carrinho compactado em campos de bits.
+ *
+ * Com 2 KB de SRAM, flags e contadores pequenos de vários módulos dividem
+ * poucos bytes aqui. Só o laço principal mexe nestes campos: uma escrita em
+ * campo de bits é ler-modificar-escrever, então variáveis tocadas por ISR
+ * continuam como bytes volatile nos seus módulos.
+ *
+ * Acesse sempre pelos macros; o layout pode mudar.
+ */
+#ifndef STATE_H
+#define STATE_H
+
+#include <stdint.h>
+
+struct car_state {
+    /* jogo */
+    uint8_t lives      : 2;   /* 0..3 LEDs acesos */
+    uint8_t out        : 1;   /* sem vidas: movimento desabilitado */
+    uint8_t derating   : 1;   /* thermal reduzindo o duty */
+    uint8_t gyro_read  : 1;   /* leitura do giroscópio em andamento */
+    uint8_t team       : 2;   /* equipe 0..3 (laser e telemetria) */
+    uint8_t teams      : 1;   /* jogo em equipes: filtra fogo amigo */
+    /* rádio */
+    uint8_t paired     : 1;   /* vínculo válido em uso */
+    uint8_t pair_state : 3;   /* enum pairing_state */
+    uint8_t group_slot : 3;   /* 0..5; CAR_NO_SLOT fora de grupo */
+    uint8_t            : 1;
+};
+
+#define CAR_NO_SLOT 7
+
+extern struct car_state car;
+
+#define CAR_LIVES()            (car.lives)
+#define CAR_SET_LIVES(n)       (car.lives = (n))
+#define CAR_IS_OUT()           (car.out)
+#define CAR_SET_OUT(v)         (car.out = (v))
+#define CAR_DERATING()         (car.derating)
+#define CAR_SET_DERATING(v)    (car.derating = (v))
+#define CAR_TEAM()             (car.team)
+#define CAR_SET_TEAM(v)        (car.team = (v))
+#define CAR_TEAMS()            (car.teams)
+#define CAR_SET_TEAMS(v)       (car.teams = (v))
+#define CAR_GYRO_READ()        (car.gyro_read)
+#define CAR_SET_GYRO_READ(v)   (car.gyro_read = (v))
+#define CAR_PAIRED()           (car.paired)
+#define CAR_SET_PAIRED(v)      (car.paired = (v))
+#define CAR_PAIR_STATE()       (car.pair_state)
+#define CAR_SET_PAIR_STATE(v)  (car.pair_state = (v))
+#define CAR_GROUP_SLOT()       (car.group_slot)
+#define CAR_SET_GROUP_SLOT(v)  (car.group_slot = (v))
+
+#endif /* STATE_H */
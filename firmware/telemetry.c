@@ -0,0 +1,158 @@
+#include "telemetry.h"
+
+#include <string.h>
+
+static uint8_t put_varint(uint8_t *p, uint16_t v)
+{
+    uint8_t n = 0;
+
+    while (v >= 0x80) {   /* wcet-loop: 3 */
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/* Retorna bytes consumidos, 0 se truncado ou longo demais. */
+static uint8_t get_varint(const uint8_t *p, uint8_t len, uint16_t *v)
+{
+    uint8_t n = 0, shift = 0;
+
+    *v = 0;
+    while (n < len && n < 3) {   /* wcet-loop: 3 */
+        *v |= (uint16_t)(p[n] & 0x7F) << shift;
+        if (!(p[n++] & 0x80))
+            return n;
+        shift += 7;
+    }
+    return 0;
+}
+
+static uint16_t zigzag(int16_t v)
+{
+    return (uint16_t)(((uint16_t)v << 1) ^ (uint16_t)(v >> 15));
+}
+
+static int16_t unzigzag(uint16_t v)
+{
+    return (int16_t)((v >> 1) ^ (uint16_t)-(int16_t)(v & 1));
+}
+
+/* seq nunca vale 0, que marca "sem base" */
+static uint8_t next_seq(uint8_t s)
+{
+    return (uint8_t)(s == 255 ? 1 : s + 1);
+}
+
+static uint8_t seq_dist(uint8_t from, uint8_t to)
+{
+    return (uint8_t)(to >= from ? to - from : to - from - 1);
+}
+
+void tlm_encoder_init(struct tlm_encoder *e)
+{
+    memset(e, 0, sizeof(*e));
+}
+
+uint8_t tlm_encode(struct tlm_encoder *e, const int16_t now[TLM_FIELD_COUNT],
+                   uint8_t *out)
+{
+    static const int16_t zeros[TLM_FIELD_COUNT];
+    const int16_t *base;
+    uint16_t mask = 0;
+    uint8_t i, n;
+
+    e->seq = next_seq(e->seq);
+
+    /* a base precisa ainda estar no histórico do decodificador */
+    if (e->acked_seq && seq_dist(e->acked_seq, e->seq) < TLM_HISTORY) {
+        base = e->acked;
+    } else {
+        e->acked_seq = 0;
+        base = zeros;
+    }
+
+    /* Só um registro em voo serve de candidato a base; os seguintes são
+     * enviados normalmente até ele ser confirmado ou expirar. */
+    if (e->pending_seq == 0 ||
+        seq_dist(e->pending_seq, e->seq) >= TLM_HISTORY) {
+        memcpy(e->pending, now, sizeof(e->pending));
+        e->pending_seq = e->seq;
+    }
+
+    out[0] = TLM_RECORD;
+    out[1] = e->seq;
+    out[2] = e->acked_seq;
+    for (i = 0; i < TLM_FIELD_COUNT; i++)   /* wcet-loop: 9 */
+        if (now[i] != base[i])
+            mask |= (uint16_t)1 << i;
+    n = 3 + put_varint(out + 3, mask);
+    for (i = 0; i < TLM_FIELD_COUNT; i++)   /* wcet-loop: 9 */
+        if (mask & ((uint16_t)1 << i))
+            n += put_varint(out + n, zigzag((int16_t)(now[i] - base[i])));
+    return n;
+}
+
+void tlm_acked(struct tlm_encoder *e, uint8_t seq)
+{
+    uint8_t fresh;
+
+    if (seq == 0)
+        return;
+    fresh = seq != e->last_ack;
+    e->last_ack = seq;
+    if (!fresh || seq != e->pending_seq)
+        return;
+    memcpy(e->acked, e->pending, sizeof(e->acked));
+    e->acked_seq = seq;
+    e->pending_seq = 0;
+}
+
+void tlm_decoder_init(struct tlm_decoder *d)
+{
+    memset(d, 0, sizeof(*d));
+}
+
+uint8_t tlm_decode(struct tlm_decoder *d, const uint8_t *pkt, uint8_t len,
+                   int16_t out[TLM_FIELD_COUNT])
+{
+    uint8_t seq, base_seq, i, n, used;
+    uint16_t mask, v;
+    const int16_t *base = NULL;
+
+    if (len < 4 || pkt[0] != TLM_RECORD || pkt[1] == 0)
+        return 0;
+    seq = pkt[1];
+    base_seq = pkt[2];
+    if (base_seq) {
+        if (seq_dist(base_seq, seq) >= TLM_HISTORY)
+            return 0;
+        for (i = 0; i < TLM_HISTORY; i++)   /* wcet-loop: TLM_HISTORY */
+            if (d->hist_seq[i] == base_seq)
+                base = d->hist[i];
+        if (!base)
+            return 0;
+    }
+
+    n = 3;
+    used = get_varint(pkt + n, (uint8_t)(len - n), &mask);
+    if (!used)
+        return 0;
+    n += used;
+    for (i = 0; i < TLM_FIELD_COUNT; i++) {   /* wcet-loop: 9 */
+        out[i] = base ? base[i] : 0;
+        if (mask & ((uint16_t)1 << i)) {
+            used = get_varint(pkt + n, (uint8_t)(len - n), &v);
+            if (!used)
+                return 0;
+            n += used;
+            out[i] = (int16_t)(out[i] + unzigzag(v));
+        }
+    }
+
+    i = seq % TLM_HISTORY;
+    memcpy(d->hist[i], out, sizeof(d->hist[i]));
+    d->hist_seq[i] = seq;
+    return seq;
+}
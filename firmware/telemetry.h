@@ -0,0 +1,94 @@
+/*
+ * Codificação compacta da telemetria (delta + zigzag varint).
+ *
+ * Cada registro é comparado com o último que o outro lado confirmou ter
+ * recebido (ele devolve o seq no comando seguinte). Campos iguais só
+ * ocupam um bit zerado na máscara; os demais vão como diferença em zigzag
+ * varint (1 byte para |delta| < 64).
+ *
+ *   [TLM_RECORD] [seq] [base] [máscara varint] [delta varint]...
+ *
+ * base = 0 quer dizer "diferença contra zeros" (registro completo), usado
+ * no início e quando a confirmação demora mais que TLM_HISTORY registros.
+ *
+ * O seq tem 8 bits e dá a volta. Uma confirmação só vale quando o valor
+ * devolvido muda, o que acontece depois de o registro sair; um valor que
+ * o transmissor vem repetindo desde antes é de um registro mais velho com
+ * o mesmo número. O decodificador também recusa base a TLM_HISTORY ou mais
+ * registros de distância.
+ *
+ * Código C puro, sem AVR: o mesmo arquivo compila no gateway para o
+ * decodificador.
+ */
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#define TLM_RECORD 0x20
+
+/* Campos do registro, todos int16. */
+enum tlm_field {
+    TLM_LIVES = 0,
+    TLM_FLAGS,        /* TLM_F_* abaixo */
+    TLM_X_CM,
+    TLM_Y_CM,
+    TLM_THETA,        /* 1/256 de volta */
+    TLM_TEMP_C,       /* MOSFET estimado */
+    TLM_DERATE,       /* fator 0..256 */
+    TLM_LINK,         /* pacotes recebidos na última janela */
+    TLM_AMMO,         /* laser_ammo_report() */
+    TLM_FIELD_COUNT
+};
+
+/*
+ * Bits de TLM_FLAGS. Posições fixas do formato, independentes do layout de
+ * struct car_state.
+ */
+#define TLM_F_OUT         0x0001   /* sem vidas */
+#define TLM_F_DERATING    0x0002   /* thermal reduzindo o duty */
+#define TLM_F_TEAMS       0x0004   /* jogo em equipes */
+#define TLM_F_TEAM_SHIFT  3        /* 2 bits: equipe 0..3 */
+#define TLM_F_TEAM_MASK   (3 << TLM_F_TEAM_SHIFT)
+#define TLM_F_SLOT_SHIFT  5        /* 3 bits: slot do grupo, 7 = fora */
+#define TLM_F_SLOT_MASK   (7 << TLM_F_SLOT_SHIFT)
+
+/* Registros que o decodificador guarda para servir de base. */
+#define TLM_HISTORY 8
+
+/* Pior caso: cabeçalho + máscara (2 bytes até 14 campos) + 3 por campo. */
+#define TLM_MAX_SIZE (3 + 2 + 3 * TLM_FIELD_COUNT)
+
+struct tlm_encoder {
+    int16_t acked[TLM_FIELD_COUNT];
+    int16_t pending[TLM_FIELD_COUNT];
+    uint8_t seq;
+    uint8_t acked_seq;     /* 0 = nenhum */
+    uint8_t pending_seq;   /* 0 = nenhum em voo */
+    uint8_t last_ack;      /* último valor devolvido, para ver se mudou */
+};
+
+struct tlm_decoder {
+    int16_t hist[TLM_HISTORY][TLM_FIELD_COUNT];
+    uint8_t hist_seq[TLM_HISTORY];
+};
+
+void tlm_encoder_init(struct tlm_encoder *e);
+
+/* Retorna o tamanho escrito em out (no máximo TLM_MAX_SIZE). */
+uint8_t tlm_encode(struct tlm_encoder *e, const int16_t now[TLM_FIELD_COUNT],
+                   uint8_t *out);
+
+/* O outro lado devolveu 'seq' (0 = nada); só vale se o valor mudou. */
+void tlm_acked(struct tlm_encoder *e, uint8_t seq);
+
+void tlm_decoder_init(struct tlm_decoder *d);
+
+/*
+ * Decodifica em out[]; retorna o seq (a devolver como confirmação) ou 0 se
+ * o pacote é inválido ou a base já saiu do histórico.
+ */
+uint8_t tlm_decode(struct tlm_decoder *d, const uint8_t *pkt, uint8_t len,
+                   int16_t out[TLM_FIELD_COUNT]);
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,16 @@
+/*
+ * avr/io.h de host, só com o que os módulos dos alvos de fuzzing usam
+ * (command.c, hitpush.c, lives.c). As portas viram variáveis em stubs.c.
+ */
+#ifndef FUZZ_AVR_IO_H
+#define FUZZ_AVR_IO_H
+
+#include <stdint.h>
+
+#define _BV(bit) (1u << (bit))
+
+extern uint8_t DDRC, PORTC;
+
+enum { PC1 = 1, PC2 = 2, PC3 = 3 };
+
+#endif /* FUZZ_AVR_IO_H */
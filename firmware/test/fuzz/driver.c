@@ -0,0 +1,316 @@
+/*
+ * Laço de fuzzing para os alvos (LLVMFuzzerTestOneInput) sem libFuzzer, só
+ * com o compilador do host.
+ *
+ * Roda cada entrada do corpus uma vez, como regressão, e depois muta
+ * entradas do corpus até o tempo acabar. Com os alvos compilados com
+ * -fsanitize-coverage=trace-pc (make fuzz), a entrada que passa por um
+ * trecho novo de código entra no corpus em memória: a busca é guiada por
+ * cobertura como no libFuzzer, só que por bordas vistas, sem contagem.
+ *
+ *   fuzz_command [-t segundos] [-r execs/s] [-s semente] corpus/command ...
+ *
+ * Sai com erro se a vazão ficar abaixo de -r. Se o alvo quebrar
+ * (FUZZ_CHECK, sanitizer ou sinal), a entrada vai para <executável>.crash
+ * e pode ser repetida passando o arquivo no lugar do corpus.
+ *
+ * Com clang o mesmo alvo liga direto no libFuzzer, sem este arquivo:
+ *   clang -fsanitize=fuzzer,address -Itest/fuzz -I. \
+ *       test/fuzz/fuzz_telemetry.c telemetry.c test/fuzz/stubs.c
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fuzz.h"
+
+#define MAX_LEN     256
+#define MAX_CORPUS  4096
+#define COV_SIZE    (1u << 16)
+#define TIME_EVERY  1024        /* execuções entre leituras do relógio */
+
+struct input {
+    size_t len;
+    uint8_t data[MAX_LEN];
+};
+
+static struct input *corpus;
+static size_t count;
+
+static uint8_t cur[MAX_LEN];
+static size_t cur_len;
+static char crash_path[512];
+
+static uint8_t seen[COV_SIZE];
+static size_t edges;
+static int new_edge;
+
+static uint32_t rng;
+
+/* Chamado pelo compilador em cada borda dos alvos (trace-pc). */
+void __sanitizer_cov_trace_pc(void)
+{
+    uint64_t pc = (uintptr_t)__builtin_return_address(0);
+    uint32_t h = (uint32_t)(pc ^ pc >> 32) * 2654435761u >> 16;
+
+    if (!seen[h]) {
+        seen[h] = 1;
+        edges++;
+        new_edge = 1;
+    }
+}
+
+/* Só existe quando algum sanitizer está ligado. */
+extern void __sanitizer_set_death_callback(void (*cb)(void))
+    __attribute__((weak));
+
+/* Só write(): roda dentro de handler de sinal. */
+static void put(int fd, const void *buf, size_t len)
+{
+    ssize_t r = write(fd, buf, len);
+
+    (void)r;
+}
+
+static void save_crash(void)
+{
+    static const char msg[] = "entrada salva em ";
+    int fd = open(crash_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (fd < 0)
+        return;
+    put(fd, cur, cur_len);
+    close(fd);
+    put(2, msg, sizeof(msg) - 1);
+    put(2, crash_path, strlen(crash_path));
+    put(2, "\n", 1);
+}
+
+static void on_signal(int sig)
+{
+    save_crash();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static uint32_t rnd(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Copia para um bloco do tamanho exato, para o sanitizer ver o fim. */
+static void run(void)
+{
+    uint8_t *buf = malloc(cur_len ? cur_len : 1);
+
+    if (!buf)
+        abort();
+    memcpy(buf, cur, cur_len);
+    LLVMFuzzerTestOneInput(buf, cur_len);
+    free(buf);
+}
+
+static void add(const uint8_t *data, size_t len)
+{
+    if (count == MAX_CORPUS)
+        return;
+    if (len > MAX_LEN)
+        len = MAX_LEN;
+    memcpy(corpus[count].data, data, len);
+    corpus[count].len = len;
+    count++;
+}
+
+static void load_file(const char *path)
+{
+    uint8_t buf[MAX_LEN];
+    FILE *f = fopen(path, "rb");
+    size_t n;
+
+    if (!f) {
+        perror(path);
+        exit(2);
+    }
+    n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    add(buf, n);
+}
+
+static void load(const char *path)
+{
+    struct stat st;
+    struct dirent *e;
+    DIR *d;
+    char sub[1024];
+
+    if (stat(path, &st) != 0) {
+        perror(path);
+        exit(2);
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        load_file(path);
+        return;
+    }
+    d = opendir(path);
+    while (d && (e = readdir(d)) != NULL) {
+        if (e->d_name[0] == '.')
+            continue;
+        snprintf(sub, sizeof(sub), "%s/%s", path, e->d_name);
+        if (stat(sub, &st) == 0 && S_ISREG(st.st_mode))
+            load_file(sub);
+    }
+    if (d)
+        closedir(d);
+}
+
+/* Mutações do libFuzzer, as mais simples. */
+static void mutate(void)
+{
+    static const uint8_t magic[] = { 0x00, 0x01, 0x7F, 0x80, 0xFE, 0xFF };
+    int k, rounds = 1 + rnd() % 4;
+    size_t i, n;
+
+    for (k = 0; k < rounds; k++) {
+        i = cur_len ? rnd() % cur_len : 0;
+        switch (rnd() % 7) {
+        case 0:         /* inverte um bit */
+            if (cur_len)
+                cur[i] ^= (uint8_t)(1u << (rnd() % 8));
+            break;
+        case 1:         /* byte qualquer */
+            if (cur_len)
+                cur[i] = (uint8_t)rnd();
+            break;
+        case 2:         /* valor de fronteira */
+            if (cur_len)
+                cur[i] = magic[rnd() % sizeof(magic)];
+            break;
+        case 3:         /* insere */
+            if (cur_len < MAX_LEN) {
+                memmove(cur + i + 1, cur + i, cur_len - i);
+                cur[i] = (uint8_t)rnd();
+                cur_len++;
+            }
+            break;
+        case 4:         /* apaga */
+            if (cur_len) {
+                memmove(cur + i, cur + i + 1, cur_len - i - 1);
+                cur_len--;
+            }
+            break;
+        case 5:         /* corta o fim */
+            cur_len = i;
+            break;
+        case 6: {       /* trecho de outra entrada */
+            const struct input *o = &corpus[rnd() % count];
+            size_t j;
+
+            if (!o->len)
+                break;
+            j = rnd() % o->len;
+            n = 1 + rnd() % (o->len - j);
+            if (i + n > MAX_LEN)
+                n = MAX_LEN - i;
+            memcpy(cur + i, o->data + j, n);
+            if (i + n > cur_len)
+                cur_len = i + n;
+            break;
+        }
+        }
+    }
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "uso: %s [-t segundos] [-r execs/s] [-s semente] "
+            "corpus|arquivo ...\n", name);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    const char *name = strrchr(argv[0], '/') ? strrchr(argv[0], '/') + 1
+                                             : argv[0];
+    double seconds = 10.0, min_rate = 0.0, t0, t;
+    unsigned long execs = 0;
+    size_t seeds, k;
+    int opt;
+
+    rng = 1;
+    while ((opt = getopt(argc, argv, "t:r:s:")) != -1) {
+        switch (opt) {
+        case 't': seconds = atof(optarg); break;
+        case 'r': min_rate = atof(optarg); break;
+        case 's': rng = (uint32_t)strtoul(optarg, NULL, 0) | 1; break;
+        default: usage(name);
+        }
+    }
+    if (optind == argc)
+        usage(name);
+
+    snprintf(crash_path, sizeof(crash_path), "%s.crash", argv[0]);
+    if (__sanitizer_set_death_callback)
+        __sanitizer_set_death_callback(save_crash);
+    signal(SIGABRT, on_signal);
+    signal(SIGSEGV, on_signal);
+    signal(SIGFPE, on_signal);
+    signal(SIGBUS, on_signal);
+
+    corpus = malloc(MAX_CORPUS * sizeof(*corpus));
+    if (!corpus)
+        abort();
+    for (; optind < argc; optind++)
+        load(argv[optind]);
+    if (!count)
+        add(NULL, 0);
+    seeds = count;
+
+    t0 = now();
+    for (k = 0; k < seeds; k++) {
+        cur_len = corpus[k].len;
+        memcpy(cur, corpus[k].data, cur_len);
+        run();
+        execs++;
+    }
+
+    for (t = now(); t - t0 < seconds; ) {
+        const struct input *in = &corpus[rnd() % count];
+
+        cur_len = in->len;
+        memcpy(cur, in->data, cur_len);
+        mutate();
+        new_edge = 0;
+        run();
+        execs++;
+        if (new_edge)
+            add(cur, cur_len);
+        if (execs % TIME_EVERY == 0)
+            t = now();
+    }
+    t = now() - t0;
+
+    printf("%s: %zu sementes, %lu execuções em %.1f s (%.0f/s), "
+           "%zu bordas, corpus %zu\n", name, seeds, execs, t,
+           t > 0 ? execs / t : 0.0, edges, count);
+    if (t > 0 && seconds > 0 && execs / t < min_rate) {
+        printf("%s: abaixo da meta de %.0f execuções/s\n", name, min_rate);
+        return 1;
+    }
+    return 0;
+}
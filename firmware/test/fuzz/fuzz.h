@@ -0,0 +1,94 @@
+/*
+ * Comum aos alvos de fuzzing (test/fuzz/fuzz_*.c).
+ *
+ * Cada alvo é um LLVMFuzzerTestOneInput(): liga no libFuzzer com clang ou
+ * no laço de driver.c com qualquer compilador do host (make fuzz). Os
+ * módulos do firmware entram sem mudança; o que eles pedem ao hardware
+ * (rádio, PWM, laser, buzzer, portas) cai nos substitutos de stubs.c, que
+ * guardam as chamadas para os alvos conferirem.
+ */
+#ifndef FUZZ_H
+#define FUZZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nrf24.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/* Invariante quebrada: aborta, e o driver (ou o libFuzzer) salva a entrada. */
+#define FUZZ_CHECK(c) do { \
+        if (!(c)) { \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #c); \
+            abort(); \
+        } \
+    } while (0)
+
+/*
+ * As entradas são sequências de pacotes do rádio:
+ *
+ *   [cabeçalho] [payload] [cabeçalho] [payload] ...
+ *
+ * cabeçalho: bit 7 = pipe 1 (senão pipe 0), bit 6 = evento do alvo (acerto,
+ * pacote perdido...), bits 0..4 = tamanho - 1. O tamanho vai de 1 a
+ * NRF_MAX_PAYLOAD, como nrf24_available() entrega; um payload cortado no
+ * fim da entrada fica com o que sobrou. O payload vai para um bloco do
+ * tamanho exato, para o sanitizer pegar leitura além do fim.
+ */
+struct fuzz_packet {
+    uint8_t *data;
+    uint8_t len;
+    uint8_t pipe;
+    uint8_t event;
+};
+
+#define FUZZ_PIPE1   0x80
+#define FUZZ_EVENT   0x40
+#define FUZZ_LEN     0x1F
+
+/* Retorna 0 quando a entrada acaba; senão o chamador libera p->data. */
+static inline int fuzz_next(const uint8_t **in, size_t *left,
+                            struct fuzz_packet *p)
+{
+    uint8_t h;
+    size_t n;
+
+    if (*left < 2)
+        return 0;
+    h = (*in)[0];
+    n = (size_t)(h & FUZZ_LEN) + 1;
+    if (n > *left - 1)
+        n = *left - 1;
+    p->data = malloc(n);
+    if (!p->data)
+        abort();
+    memcpy(p->data, *in + 1, n);
+    p->len = (uint8_t)n;
+    p->pipe = (h & FUZZ_PIPE1) ? 1 : 0;
+    p->event = (h & FUZZ_EVENT) != 0;
+    *in += 1 + n;
+    *left -= 1 + n;
+    return 1;
+}
+
+/* ---- stubs.c ------------------------------------------------------------ */
+
+/* Rádio */
+extern uint8_t stub_pipes;                  /* EN_RXADDR */
+extern uint8_t stub_rx_addr[6][NRF_ADDR_LEN];
+extern uint8_t stub_ack[NRF_MAX_PAYLOAD];   /* payload de ACK na fila */
+extern uint8_t stub_ack_len;                /* 0 = fila vazia */
+extern unsigned stub_ack_loads;             /* nrf24_write_ack() chamadas */
+
+/* Saídas do jogo */
+extern uint8_t stub_pwm_left, stub_pwm_right;
+extern uint8_t stub_laser;
+extern int stub_melody;                     /* -1 = nenhuma */
+
+void stub_reset(void);
+
+#endif /* FUZZ_H */
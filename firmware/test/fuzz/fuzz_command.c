@@ -0,0 +1,104 @@
+/*
+ * Alvo de fuzzing do lado do carrinho: pacotes recebidos despachados como em
+ * radio_poll() (main.c) por command_decode(), command_poll_ack() e
+ * command_control(), com CMD_MATCH e os acertos (bit de evento do
+ * cabeçalho, fuzz.h) passando por lives.c de verdade.
+ *
+ * Depois de cada pacote confere:
+ *   - comando aceito só do tipo certo no pipe certo, e com os bytes dele;
+ *     equipe 0..3 ou HIT_NO_TEAM
+ *   - slot do grupo válido e o pipe 1 ligado só dentro de um grupo
+ *   - consulta e controle só no pipe privado, com o tamanho mínimo
+ *   - vidas de 0 a LIVES_MAX, "fora" só sem vidas, LEDs iguais às vidas;
+ *     fora, laser desligado e motores parados
+ */
+#include "config.h"
+#include "buzzer.h"
+#include "command.h"
+#include "fuzz.h"
+#include "laser.h"
+#include "lives.h"
+#include "state.h"
+
+static void check_command(const struct fuzz_packet *p,
+                          const struct command *cmd)
+{
+    const uint8_t team = CMD_TEAM(cmd->flags);
+    const uint8_t *s;
+
+    if (p->pipe == CMD_PIPE_PRIVATE) {
+        FUZZ_CHECK(p->data[0] == CMD_SINGLE && p->len >= CMD_SINGLE_SIZE);
+        FUZZ_CHECK(cmd->tlm_ack == p->data[4]);
+        s = p->data + 1;
+    } else {
+        FUZZ_CHECK(p->data[0] == CMD_MULTI);
+        FUZZ_CHECK(CAR_GROUP_SLOT() < CMD_MAX_CARS);
+        FUZZ_CHECK(p->data[2] & _BV(CAR_GROUP_SLOT()));
+        FUZZ_CHECK(p->len >= CMD_MULTI_HDR +
+                   (CAR_GROUP_SLOT() + 1) * CMD_SLOT_SIZE);
+        FUZZ_CHECK(cmd->tlm_ack == 0);
+        s = p->data + CMD_MULTI_HDR + CAR_GROUP_SLOT() * CMD_SLOT_SIZE;
+    }
+    FUZZ_CHECK(cmd->throttle == s[0] && (uint8_t)cmd->steer == s[1] &&
+               cmd->flags == s[2]);
+    FUZZ_CHECK(team < LASER_TEAMS || team == HIT_NO_TEAM);
+}
+
+static void check_state(void)
+{
+    const uint8_t slot = CAR_GROUP_SLOT();
+    const uint8_t n = CAR_LIVES();
+
+    FUZZ_CHECK(slot < CMD_MAX_CARS || slot == CAR_NO_SLOT);
+    FUZZ_CHECK((slot != CAR_NO_SLOT) == !!(stub_pipes & _BV(CMD_PIPE_GROUP)));
+
+    FUZZ_CHECK(n <= LIVES_MAX);
+    FUZZ_CHECK(CAR_IS_OUT() == (n == 0));
+    FUZZ_CHECK((PORTC & LIFE_MASK) >> LIFE_SHIFT == (1u << n) - 1);
+    if (CAR_IS_OUT())
+        FUZZ_CHECK(!stub_laser && stub_pwm_left == 0 && stub_pwm_right == 0 &&
+                   stub_melody == MELODY_OUT);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    struct fuzz_packet p;
+    struct command cmd;
+    uint8_t ack, ctl;
+
+    stub_reset();
+    command_leave_group();
+    lives_init();
+
+    while (fuzz_next(&data, &size, &p)) {
+        if (p.event) {
+            /* acerto detectado por hit.c */
+            lives_hit();
+        } else if (command_decode(p.data, p.len, p.pipe, &cmd)) {
+            check_command(&p, &cmd);
+        } else if ((ack = command_poll_ack(p.data, p.len, p.pipe)) != 0) {
+            FUZZ_CHECK(p.pipe == CMD_PIPE_PRIVATE && p.len >= CMD_POLL_SIZE &&
+                       p.data[0] == CMD_POLL && ack == p.data[1]);
+        } else if ((ctl = command_control(p.data, p.len, p.pipe)) != 0) {
+            FUZZ_CHECK(p.pipe == CMD_PIPE_PRIVATE && ctl == p.data[0]);
+            switch (ctl) {
+            case CMD_CHANNELS:
+                break;
+            case CMD_REPAIR:
+                command_leave_group();
+                break;
+            case CMD_MATCH:
+                lives_reset();
+                break;
+            case CMD_PWM_FREQ:
+                FUZZ_CHECK(p.len >= CMD_PWM_FREQ_SIZE);
+                break;
+            default:
+                FUZZ_CHECK(!"tipo de controle desconhecido");
+            }
+        }
+        free(p.data);
+        check_state();
+    }
+    return 0;
+}
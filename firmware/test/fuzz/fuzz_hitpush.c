@@ -0,0 +1,75 @@
+/*
+ * Alvo de fuzzing do aviso de acerto (hitpush.c), nos dois lados.
+ *
+ * Pacote comum: payload de ACK qualquer entregue a hitpush_decode(), como
+ * no transmissor. Aceito, tem de trazer um seq novo e diferente de zero, e
+ * o evento sai com os bytes do pacote.
+ *
+ * Pacote com o bit de evento (fuzz.h): ação do carrinho. Com o bit do pipe
+ * é um acerto (hitpush_hit() com equipe e vidas do payload); senão um
+ * pacote recebido (hitpush_on_rx()). O que o carrinho deixa na fila do ACK
+ * vai para um segundo transmissor: cada acerto chega uma vez só, com os
+ * dados certos, e as repetições não passam de HITPUSH_REPEATS envios.
+ */
+#include "fuzz.h"
+#include "hitpush.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    struct fuzz_packet p;
+    struct hit_event evt;
+    uint8_t last = 0, peer_last = 0, team = 0, lives = 0;
+    unsigned sent = 0, loads;
+    int pending = 0;
+
+    /* repetições da entrada anterior não contam nesta */
+    while (hitpush_on_rx())
+        ;
+    stub_reset();
+
+    while (fuzz_next(&data, &size, &p)) {
+        if (!p.event) {
+            uint8_t before = last;
+
+            if (hitpush_decode(p.data, p.len, &evt, &last)) {
+                FUZZ_CHECK(p.len >= EVT_HIT_SIZE && p.data[0] == EVT_HIT);
+                FUZZ_CHECK(evt.seq != 0 && evt.seq != before &&
+                           evt.seq == last);
+                FUZZ_CHECK(evt.shooter_team == p.data[2] &&
+                           evt.lives == p.data[3]);
+            } else {
+                FUZZ_CHECK(last == before);
+            }
+            free(p.data);
+            continue;
+        }
+
+        loads = stub_ack_loads;
+        if (p.pipe) {
+            team = p.data[0];
+            lives = p.len > 1 ? p.data[1] : 0;
+            hitpush_hit(team, lives);
+            FUZZ_CHECK(stub_ack_loads == loads + 1);
+            pending = 1;
+            sent = 1;
+        } else if (hitpush_on_rx()) {
+            FUZZ_CHECK(stub_ack_loads == loads + 1);
+            FUZZ_CHECK(++sent <= HITPUSH_REPEATS);
+        } else {
+            FUZZ_CHECK(stub_ack_loads == loads);
+        }
+        free(p.data);
+
+        if (stub_ack_loads == loads)
+            continue;
+        /* o ACK que acabou de ser carregado chega ao transmissor */
+        if (hitpush_decode(stub_ack, stub_ack_len, &evt, &peer_last)) {
+            FUZZ_CHECK(pending);
+            FUZZ_CHECK(evt.shooter_team == team && evt.lives == lives);
+            pending = 0;
+        } else {
+            FUZZ_CHECK(!pending);
+        }
+    }
+    return 0;
+}
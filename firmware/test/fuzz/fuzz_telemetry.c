@@ -0,0 +1,62 @@
+/*
+ * Alvo de fuzzing do codec de telemetria, nos dois papéis.
+ *
+ * Pacote comum: payload de ACK qualquer entregue a tlm_decode(), como no
+ * gateway. Aceito, tem de ser um TLM_RECORD e devolver o seq dele.
+ *
+ * Pacote com o bit de evento (fuzz.h): os bytes viram um registro (int16
+ * little-endian, o que faltar é zero) que o carrinho codifica. Com o bit do
+ * pipe o pacote se perde no ar; senão um segundo decodificador, que só vê o
+ * que o carrinho mandou, tem de reproduzir o registro e confirma o seq. A
+ * ordem de perdas e confirmações fica por conta do fuzzer.
+ */
+#include "fuzz.h"
+#include "telemetry.h"
+
+static struct tlm_decoder gateway, peer;
+static struct tlm_encoder car;
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    struct fuzz_packet p;
+    int16_t now[TLM_FIELD_COUNT];
+    int16_t *out;
+    uint8_t pkt[TLM_MAX_SIZE];
+    uint8_t n, s, i;
+
+    tlm_decoder_init(&gateway);
+    tlm_decoder_init(&peer);
+    tlm_encoder_init(&car);
+
+    /* bloco do tamanho exato: escrita além de out[] aparece no sanitizer */
+    out = malloc(sizeof(now));
+    if (!out)
+        abort();
+
+    while (fuzz_next(&data, &size, &p)) {
+        if (!p.event) {
+            s = tlm_decode(&gateway, p.data, p.len, out);
+            if (s)
+                FUZZ_CHECK(p.data[0] == TLM_RECORD && p.len >= 3 &&
+                           s == p.data[1]);
+            free(p.data);
+            continue;
+        }
+
+        memset(now, 0, sizeof(now));
+        for (i = 0; i < TLM_FIELD_COUNT && 2 * i + 1 < p.len; i++)
+            now[i] = (int16_t)(p.data[2 * i] | p.data[2 * i + 1] << 8);
+        n = tlm_encode(&car, now, pkt);
+        FUZZ_CHECK(n >= 4 && n <= TLM_MAX_SIZE);
+        FUZZ_CHECK(pkt[0] == TLM_RECORD && pkt[1] != 0);
+        if (!p.pipe) {
+            s = tlm_decode(&peer, pkt, n, out);
+            FUZZ_CHECK(s == pkt[1]);
+            FUZZ_CHECK(memcmp(out, now, sizeof(now)) == 0);
+            tlm_acked(&car, s);
+        }
+        free(p.data);
+    }
+    free(out);
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * Substitutos do hardware para os alvos de fuzzing: guardam o que o
+ * firmware pediu e conferem os limites que o rádio impõe.
+ */
+#include "buzzer.h"
+#include "fuzz.h"
+#include "laser.h"
+#include "pwm.h"
+
+uint8_t DDRC, PORTC;
+
+uint8_t stub_pipes;
+uint8_t stub_rx_addr[6][NRF_ADDR_LEN];
+uint8_t stub_ack[NRF_MAX_PAYLOAD];
+uint8_t stub_ack_len;
+unsigned stub_ack_loads;
+
+uint8_t stub_pwm_left, stub_pwm_right;
+uint8_t stub_laser;
+int stub_melody;
+
+void stub_reset(void)
+{
+    DDRC = PORTC = 0;
+    stub_pipes = 0x01;          /* pipe privado, como depois do pareamento */
+    memset(stub_rx_addr, 0, sizeof(stub_rx_addr));
+    stub_ack_len = 0;
+    stub_ack_loads = 0;
+    stub_pwm_left = stub_pwm_right = 0;
+    stub_laser = 1;
+    stub_melody = -1;
+}
+
+/* ---- nRF24L01 ----------------------------------------------------------- */
+
+uint8_t nrf24_read_reg(uint8_t reg)
+{
+    return reg == NRF_REG_EN_RXADDR ? stub_pipes : 0;
+}
+
+void nrf24_set_rx_addr(uint8_t pipe, const uint8_t *addr)
+{
+    FUZZ_CHECK(pipe < 6);
+    memcpy(stub_rx_addr[pipe], addr, NRF_ADDR_LEN);
+}
+
+void nrf24_enable_pipes(uint8_t mask)
+{
+    FUZZ_CHECK((mask & ~0x3F) == 0);
+    FUZZ_CHECK(mask & 0x01);    /* o pipe privado nunca sai */
+    stub_pipes = mask;
+}
+
+void nrf24_listen(uint8_t on)
+{
+    (void)on;
+}
+
+void nrf24_flush_tx(void)
+{
+    stub_ack_len = 0;
+}
+
+void nrf24_write_ack(uint8_t pipe, const uint8_t *buf, uint8_t len)
+{
+    FUZZ_CHECK(pipe < 6);
+    FUZZ_CHECK(len >= 1 && len <= NRF_MAX_PAYLOAD);
+    memcpy(stub_ack, buf, len);
+    stub_ack_len = len;
+    stub_ack_loads++;
+}
+
+/* ---- Saídas do jogo (lives.c) ------------------------------------------- */
+
+void pwm_set(uint8_t left, uint8_t right)
+{
+    stub_pwm_left = left;
+    stub_pwm_right = right;
+}
+
+void laser_enable(uint8_t on)
+{
+    stub_laser = on;
+}
+
+void buzzer_play(enum buzzer_melody m)
+{
+    FUZZ_CHECK(m < MELODY_COUNT);
+    stub_melody = (int)m;
+}
@@ -0,0 +1,178 @@
+/*
+ * Teste do codec de telemetria no host: ida e volta com perda de pacotes
+ * e confirmação atrasada, como no ar.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "telemetry.h"
+
+static int failures;
+
+#define CHECK(c) do { \
+        if (!(c)) { \
+            printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #c); \
+            failures++; \
+        } \
+    } while (0)
+
+static uint32_t rng = 1;
+
+static uint32_t rnd(void)
+{
+    rng = rng * 1103515245u + 12345u;
+    return rng >> 16;
+}
+
+static void test_keyframe_and_unchanged(void)
+{
+    struct tlm_encoder e;
+    struct tlm_decoder d;
+    int16_t v[TLM_FIELD_COUNT] = { 3, 0, 100, -100, 7, 40, 256, 50, 10 };
+    int16_t o[TLM_FIELD_COUNT];
+    uint8_t pkt[TLM_MAX_SIZE];
+    uint8_t n, s;
+
+    tlm_encoder_init(&e);
+    tlm_decoder_init(&d);
+
+    /* sem confirmação: diferença contra zeros */
+    n = tlm_encode(&e, v, pkt);
+    CHECK(pkt[2] == 0);
+    s = tlm_decode(&d, pkt, n, o);
+    CHECK(s == 1);
+    CHECK(memcmp(o, v, sizeof(v)) == 0);
+
+    /* confirmado e sem mudança: só cabeçalho e máscara vazia */
+    tlm_acked(&e, s);
+    n = tlm_encode(&e, v, pkt);
+    CHECK(pkt[2] == s);
+    CHECK(n == 4);
+    CHECK(tlm_decode(&d, pkt, n, o) == 2);
+    CHECK(memcmp(o, v, sizeof(v)) == 0);
+}
+
+static void test_extremes(void)
+{
+    struct tlm_encoder e;
+    struct tlm_decoder d;
+    int16_t v[TLM_FIELD_COUNT];
+    int16_t o[TLM_FIELD_COUNT];
+    uint8_t pkt[TLM_MAX_SIZE];
+    uint8_t n, i;
+
+    tlm_encoder_init(&e);
+    tlm_decoder_init(&d);
+    for (i = 0; i < TLM_FIELD_COUNT; i++)
+        v[i] = (i & 1) ? -32768 : 32767;
+    n = tlm_encode(&e, v, pkt);
+    CHECK(n <= TLM_MAX_SIZE);
+    CHECK(tlm_decode(&d, pkt, n, o) != 0);
+    CHECK(memcmp(o, v, sizeof(v)) == 0);
+
+    /* diferença que dá a volta em int16 */
+    tlm_acked(&e, pkt[1]);
+    for (i = 0; i < TLM_FIELD_COUNT; i++)
+        v[i] = (i & 1) ? 32767 : -32768;
+    n = tlm_encode(&e, v, pkt);
+    CHECK(n <= TLM_MAX_SIZE);
+    CHECK(tlm_decode(&d, pkt, n, o) != 0);
+    CHECK(memcmp(o, v, sizeof(v)) == 0);
+}
+
+static void test_stream(void)
+{
+    struct tlm_encoder e;
+    struct tlm_decoder d;
+    int16_t v[TLM_FIELD_COUNT] = { 3, 0, 0, 0, 0, 40, 256, 50, 10 };
+    int16_t o[TLM_FIELD_COUNT];
+    uint8_t pkt[TLM_MAX_SIZE];
+    uint8_t acks[16] = { 0 };
+    uint8_t n, s, lag;
+    long t, bytes = 0, decoded = 0;
+
+    tlm_encoder_init(&e);
+    tlm_decoder_init(&d);
+    for (t = 0; t < 200000; t++) {
+        v[TLM_X_CM] += (int16_t)(rnd() % 5) - 2;
+        v[TLM_Y_CM] += (int16_t)(rnd() % 3) - 1;
+        if (t % 7 == 0)
+            v[TLM_THETA] += (int16_t)(rnd() % 3) - 1;
+        if (t % 500 == 0)
+            v[TLM_TEMP_C]++;
+        v[TLM_LINK] = (int16_t)(48 + rnd() % 4);
+        if (t % 20000 == 0 && v[TLM_LIVES])
+            v[TLM_LIVES]--;
+
+        n = tlm_encode(&e, v, pkt);
+        CHECK(n <= TLM_MAX_SIZE);
+        bytes += n;
+        if (rnd() % 10 == 0)
+            continue;   /* perdido */
+        s = tlm_decode(&d, pkt, n, o);
+        if (!s)
+            continue;   /* base fora do histórico: o encoder recomeça */
+        decoded++;
+        if (memcmp(o, v, sizeof(v)) != 0) {
+            printf("divergência no registro %ld\n", t);
+            failures++;
+            return;
+        }
+        /* confirmação chega com atraso aleatório de 0 a 15 registros */
+        lag = (uint8_t)(rnd() % 16);
+        tlm_acked(&e, acks[(t + lag) % 16]);
+        acks[(t + lag) % 16] = s;
+    }
+    CHECK(decoded > 170000);
+    printf("fluxo: %.2f bytes/registro (bruto %d)\n",
+           (double)bytes / 200000, 2 + 2 * TLM_FIELD_COUNT);
+}
+
+/*
+ * O transmissor decodificou só o primeiro registro e fica devolvendo o seq
+ * dele. Depois de algumas voltas do seq de 8 bits o registro em voo tem o
+ * mesmo número: a confirmação velha não pode virar base.
+ */
+static void test_stale_ack(void)
+{
+    struct tlm_encoder e;
+    struct tlm_decoder d;
+    int16_t v[TLM_FIELD_COUNT] = { 3, 0, 0, 0, 0, 40, 256, 50, 10 };
+    int16_t o[TLM_FIELD_COUNT];
+    uint8_t pkt[TLM_MAX_SIZE];
+    uint8_t n, s;
+    long t;
+
+    tlm_encoder_init(&e);
+    tlm_decoder_init(&d);
+    n = tlm_encode(&e, v, pkt);
+    s = tlm_decode(&d, pkt, n, o);
+    CHECK(s == 1);
+    for (t = 0; t < 4000; t++) {
+        tlm_acked(&e, s);
+        v[TLM_X_CM]++;
+        n = tlm_encode(&e, v, pkt);
+        if (pkt[2] == 0)
+            continue;   /* completo: não mexe no histórico velho */
+        if (tlm_decode(&d, pkt, n, o) && memcmp(o, v, sizeof(v)) != 0) {
+            printf("base velha aceita no registro %ld\n", t);
+            failures++;
+            return;
+        }
+    }
+}
+
+int main(void)
+{
+    test_keyframe_and_unchanged();
+    test_extremes();
+    test_stream();
+    test_stale_ack();
+    if (failures) {
+        printf("%d falha(s)\n", failures);
+        return 1;
+    }
+    printf("telemetry_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "config.h"
+#include "adc.h"
+#include "progmem.h"
+#include "state.h"
+#include "thermal.h"
+
+#include <avr/io.h>
+
+#define C_TO_Q4(c) ((int16_t)(c) * 16)
+
+static int16_t board_q4;
+static int16_t rise_q4;        /* elevação estimada sobre a placa */
+static int16_t mosfet_q4;
+static uint16_t factor = 256;
+static uint8_t ts_count;
+
+#ifdef ADC_CH_NTC
+/* ADC do NTC de 0 a 120 °C em passos de 10 °C (valores decrescentes). */
+static const uint16_t ntc_table[] PROGMEM = {
+    788, 684, 569, 456, 354, 270, 204, 153, 115, 87, 67, 51, 40
+};
+#define NTC_POINTS (sizeof(ntc_table) / sizeof(ntc_table[0]))
+#endif
+
+#ifdef ADC_CH_NTC
+static int16_t ntc_to_q4(uint16_t adc)
+{
+    uint8_t i;
+    uint16_t hi, lo;
+
+    if (adc >= pgm_u16(&ntc_table[0]))
+        return 0;
+    for (i = 1; i < NTC_POINTS; i++) {   /* wcet-loop: 13 */
+        lo = pgm_u16(&ntc_table[i]);
+        if (adc >= lo) {
+            hi = pgm_u16(&ntc_table[i - 1]);
+            /* interpolação linear dentro do intervalo de 10 °C */
+            return C_TO_Q4((i - 1) * 10) +
+                   (int16_t)((uint32_t)(hi - adc) * 160 / (hi - lo));
+        }
+    }
+    return C_TO_Q4((NTC_POINTS - 1) * 10);
+}
+#endif
+
+/* Potência de condução de um MOSFET em mW: I² · Rds(on) · D. */
+static uint16_t conduction_mw(uint8_t duty, uint16_t current_ma)
+{
+    uint32_t p;
+
+    if (current_ma == 0)
+        current_ma = (uint16_t)((uint32_t)THERMAL_MOTOR_CURRENT_MA * duty / 255);
+    p = (uint32_t)current_ma * current_ma * THERMAL_RDS_ON_MOHM / 1000000UL;
+    return (uint16_t)(p * duty / 255);
+}
+
+static void update_factor(void)
+{
+    int16_t start = C_TO_Q4(THERMAL_DERATE_START_C);
+    int16_t end = C_TO_Q4(THERMAL_DERATE_END_C);
+    uint16_t target;
+
+    if (mosfet_q4 <= start)
+        target = 256;
+    else if (mosfet_q4 >= end)
+        target = THERMAL_DERATE_MIN;
+    else
+        target = 256 - (uint16_t)((uint32_t)(mosfet_q4 - start) *
+                                  (256 - THERMAL_DERATE_MIN) / (end - start));
+
+    if (target + THERMAL_DERATE_SLEW < factor)
+        factor -= THERMAL_DERATE_SLEW;
+    else if (target > factor + THERMAL_DERATE_SLEW)
+        factor += THERMAL_DERATE_SLEW;
+    else
+        factor = target;
+    CAR_SET_DERATING(factor < 256);
+}
+
+static int16_t ts_to_q4(uint16_t adc)
+{
+    return (int16_t)(((int32_t)adc - THERMAL_TS_OFFSET) * 1600 /
+                     THERMAL_TS_GAIN_X100);
+}
+
+void thermal_init(void)
+{
+    adc_init();
+#if defined(ADC_CH_NTC) && ADC_CH_NTC < 6
+    /* ADC6/ADC7 são só analógicos e não têm bit em DIDR0 */
+    DIDR0 |= _BV(ADC_CH_NTC);
+#endif
+    board_q4 = ts_to_q4(adc_read_1v1_settled(ADC_CH_TEMP_INTERNAL));
+    mosfet_q4 = board_q4;
+    ts_count = 0;
+}
+
+void thermal_update(uint8_t duty_left, uint8_t duty_right, uint16_t current_ma)
+{
+    uint16_t adc;
+    uint16_t p_mw;
+    int16_t target;
+
+    /* sensor interno pela janela do ADC; até lá vale a leitura anterior */
+    if (adc_temp_take(&adc))
+        board_q4 = ts_to_q4(adc);
+    if (++ts_count >= THERMAL_TS_EVERY) {
+        ts_count = 0;
+        adc_temp_request();
+    }
+
+    /* Os dois MOSFETs dividem a placa; modela-se o mais carregado. */
+    p_mw = conduction_mw(duty_left, current_ma);
+    if (conduction_mw(duty_right, current_ma) > p_mw)
+        p_mw = conduction_mw(duty_right, current_ma);
+
+    /* Elevação em regime = P · Rth; o modelo se aproxima dela exponencialmente. */
+    target = (int16_t)((uint32_t)p_mw * THERMAL_RTH_JA * 16 / 1000);
+    rise_q4 += (target - rise_q4) >> THERMAL_TAU_SHIFT;
+    if (target > rise_q4 && ((target - rise_q4) >> THERMAL_TAU_SHIFT) == 0)
+        rise_q4++;
+    mosfet_q4 = board_q4 + rise_q4;
+
+#ifdef ADC_CH_NTC
+    /* com a janela aberta o ADMUX é da temperatura; o NTC espera */
+    if (!adc_in_window()) {
+        int16_t ntc = ntc_to_q4(adc_read(ADC_REF_AVCC | ADC_CH_NTC));
+        if (ntc > mosfet_q4)
+            mosfet_q4 = ntc;
+    }
+#endif
+
+    update_factor();
+}
+
+uint8_t thermal_derate(uint8_t duty)
+{
+    return (uint8_t)(((uint16_t)duty * factor) >> 8);
+}
+
+int16_t thermal_board_q4(void)  { return board_q4; }
+int16_t thermal_mosfet_q4(void) { return mosfet_q4; }
+uint16_t thermal_factor(void)   { return factor; }
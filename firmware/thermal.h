@@ -0,0 +1,81 @@
+/*
+ * Monitoramento de temperatura e derating dos motores.
+ *
+ * Lê o sensor interno do ATmega328P (temperatura da placa) e, se houver, o
+ * termistor do dissipador. Um modelo de primeira ordem estima a temperatura
+ * dos IRLZ44N a partir do duty do PWM e da corrente; acima do limiar o duty
+ * é reduzido aos poucos em vez de desligar os motores de uma vez.
+ *
+ * Temperaturas em Q4 (1/16 °C).
+ */
+#ifndef THERMAL_H
+#define THERMAL_H
+
+#include <stdint.h>
+
+/* ---- Parâmetros do modelo (ajustáveis) ---------------------------------- */
+
+/* Calibração do sensor interno: T = (ADC - OFFSET) * 100 / GAIN_X100. */
+#ifndef THERMAL_TS_OFFSET
+#define THERMAL_TS_OFFSET     324
+#endif
+#ifndef THERMAL_TS_GAIN_X100
+#define THERMAL_TS_GAIN_X100  122
+#endif
+
+/* IRLZ44N com Vgs = 5 V. */
+#ifndef THERMAL_RDS_ON_MOHM
+#define THERMAL_RDS_ON_MOHM   25
+#endif
+/* Resistência térmica junção-ambiente (TO-220 sem dissipador), °C/W. */
+#ifndef THERMAL_RTH_JA
+#define THERMAL_RTH_JA        62
+#endif
+/* Corrente do motor com duty 100% quando não há sensor de corrente. */
+#ifndef THERMAL_MOTOR_CURRENT_MA
+#define THERMAL_MOTOR_CURRENT_MA 2000
+#endif
+/*
+ * Atualizações entre leituras do sensor interno. Cada leitura tira o LDR
+ * do ar por ADC_1V1_SETTLE_MS (adc.h); a placa esquenta devagar.
+ */
+#ifndef THERMAL_TS_EVERY
+#define THERMAL_TS_EVERY      10
+#endif
+/* Constante de tempo do modelo: cada atualização anda 1/2^SHIFT do caminho. */
+#ifndef THERMAL_TAU_SHIFT
+#define THERMAL_TAU_SHIFT     6
+#endif
+
+/* Início e fim da rampa de derating, e duty mínimo no fim (x/256). */
+#ifndef THERMAL_DERATE_START_C
+#define THERMAL_DERATE_START_C 80
+#endif
+#ifndef THERMAL_DERATE_END_C
+#define THERMAL_DERATE_END_C   110
+#endif
+#ifndef THERMAL_DERATE_MIN
+#define THERMAL_DERATE_MIN     64
+#endif
+/* Variação máxima do fator por atualização (suaviza a resposta). */
+#ifndef THERMAL_DERATE_SLEW
+#define THERMAL_DERATE_SLEW    4
+#endif
+
+void thermal_init(void);
+
+/*
+ * Chamar periodicamente (ex.: a cada 100 ms) fora de interrupção.
+ * duty_* é o duty aplicado a cada motor (0..255); current_ma é a corrente
+ * medida por motor, ou 0 para estimar a partir do duty.
+ */
+void thermal_update(uint8_t duty_left, uint8_t duty_right, uint16_t current_ma);
+
+/* Aplica o fator de derating atual a um duty. */
+uint8_t thermal_derate(uint8_t duty);
+
+int16_t thermal_board_q4(void);    /* sensor interno */
+int16_t thermal_mosfet_q4(void);   /* estimativa (ou NTC, se maior) */
+uint16_t thermal_factor(void);     /* 0..256 */
+
+#endif /* THERMAL_H */
@@ -0,0 +1,133 @@
+#include "config.h"
+#include "twi.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+
+/* Códigos de status (TWSR & 0xF8) do modo mestre. */
+#define TW_START       0x08
+#define TW_REP_START   0x10
+#define TW_MT_SLA_ACK  0x18
+#define TW_MT_DATA_ACK 0x28
+#define TW_MR_SLA_ACK  0x40
+#define TW_MR_DATA_ACK 0x50
+#define TW_MR_DATA_NACK 0x58
+
+#define TWCR_GO   (_BV(TWINT) | _BV(TWEN) | _BV(TWIE))
+
+static volatile uint8_t busy;
+static volatile uint8_t error;
+static uint8_t sla;
+static uint8_t wbuf[TWI_BUF_SIZE];
+static volatile uint8_t rbuf[TWI_BUF_SIZE];
+static uint8_t wlen, rlen;
+static volatile uint8_t idx;
+
+void twi_init(void)
+{
+    TWSR = 0;
+    TWBR = (uint8_t)((F_CPU / TWI_FREQ - 16) / 2);
+    TWCR = _BV(TWEN);
+    busy = 0;
+    error = 0;
+}
+
+uint8_t twi_start(uint8_t addr, const uint8_t *w, uint8_t wl, uint8_t rl)
+{
+    uint8_t i;
+
+    if (busy || wl > TWI_BUF_SIZE || rl > TWI_BUF_SIZE)
+        return 0;
+    /* O STOP anterior precisa terminar antes de um novo START. */
+    if (TWCR & _BV(TWSTO))
+        return 0;
+    for (i = 0; i < wl; i++)   /* wcet-loop: TWI_BUF_SIZE */
+        wbuf[i] = w[i];
+    sla = (uint8_t)(addr << 1);
+    wlen = wl;
+    rlen = rl;
+    idx = 0;
+    error = 0;
+    busy = 1;
+    TWCR = TWCR_GO | _BV(TWSTA);
+    return 1;
+}
+
+uint8_t twi_read_regs(uint8_t addr, uint8_t reg, uint8_t len)
+{
+    return twi_start(addr, &reg, 1, len);
+}
+
+uint8_t twi_write_reg(uint8_t addr, uint8_t reg, uint8_t value)
+{
+    uint8_t b[2];
+
+    b[0] = reg;
+    b[1] = value;
+    return twi_start(addr, b, 2, 0);
+}
+
+void twi_abort(void)
+{
+    TWCR = 0;
+    busy = 0;
+    error = 0xFF;
+}
+
+uint8_t twi_busy(void)  { return busy; }
+uint8_t twi_error(void) { return error; }
+const volatile uint8_t *twi_rx(void) { return rbuf; }
+
+static void twi_stop(uint8_t status)
+{
+    error = status;
+    TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWSTO);
+    busy = 0;
+}
+
+ISR(TWI_vect)
+{
+    uint8_t status = TWSR & 0xF8;
+
+    switch (status) {
+    case TW_START:
+        idx = 0;
+        TWDR = wlen ? sla : (uint8_t)(sla | 1);
+        TWCR = TWCR_GO;
+        break;
+    case TW_REP_START:
+        idx = 0;
+        TWDR = sla | 1;
+        TWCR = TWCR_GO;
+        break;
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+        if (idx < wlen) {
+            TWDR = wbuf[idx++];
+            TWCR = TWCR_GO;
+        } else if (rlen) {
+            TWCR = TWCR_GO | _BV(TWSTA);
+        } else {
+            twi_stop(0);
+        }
+        break;
+    case TW_MR_DATA_ACK:
+        rbuf[idx++] = TWDR;
+        /* fall through */
+    case TW_MR_SLA_ACK:
+        /* ACK em todos os bytes menos o último */
+        if (idx + 1 < rlen)
+            TWCR = TWCR_GO | _BV(TWEA);
+        else
+            TWCR = TWCR_GO;
+        break;
+    case TW_MR_DATA_NACK:
+        rbuf[idx++] = TWDR;
+        twi_stop(0);
+        break;
+    default:
+        /* NACK de endereço/dado, perda de arbitragem, erro de barramento */
+        twi_stop(status ? status : 0xFF);
+        break;
+    }
+}
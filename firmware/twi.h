@@ -0,0 +1,37 @@
+/*
+ * Driver I2C (TWI) por interrupção, sem bloqueio.
+ *
+ * Uma transação por vez: escreve 'wlen' bytes e, se 'rlen' > 0, faz um
+ * repeated start e lê 'rlen' bytes. As funções de início retornam na hora;
+ * o resultado é consultado com twi_busy()/twi_error().
+ */
+#ifndef TWI_H
+#define TWI_H
+
+#include <stdint.h>
+
+/* Basta para o giroscópio (1 escrita de registrador + 2 bytes lidos). */
+#define TWI_BUF_SIZE 8
+
+void twi_init(void);
+
+/* Retorna 0 se o barramento estava ocupado (nada foi iniciado). */
+uint8_t twi_start(uint8_t addr, const uint8_t *wbuf, uint8_t wlen,
+                  uint8_t rlen);
+
+/* Conveniência: escreve reg e lê 'len' bytes a partir dele. */
+uint8_t twi_read_regs(uint8_t addr, uint8_t reg, uint8_t len);
+
+/* Conveniência: escreve um registrador de 8 bits. */
+uint8_t twi_write_reg(uint8_t addr, uint8_t reg, uint8_t value);
+
+/* Abandona a transação atual e desliga o TWI (barramento travado). */
+void twi_abort(void);
+
+uint8_t twi_busy(void);
+uint8_t twi_error(void);   /* status TWSR da falha, ou 0 */
+
+/* Bytes lidos na última transação (válidos quando !twi_busy()). */
+const volatile uint8_t *twi_rx(void);
+
+#endif /* TWI_H */